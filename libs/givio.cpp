@@ -275,7 +275,11 @@ GLFWContext &GLFWContext::glAntiAliasingSamples(int samples) {
 }
 
 GLFWContext &GLFWContext::matchPrimaryMonitorVideoMode() {
-  const GLFWvidmode *mode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+  GLFWmonitor *monitor = glfwGetPrimaryMonitor();
+  // Virtual displays of headless servers may have no monitor
+  if (!monitor)
+    return *this;
+  const GLFWvidmode *mode = glfwGetVideoMode(monitor);
   glfwWindowHint(GLFW_RED_BITS, mode->redBits);
   glfwWindowHint(GLFW_GREEN_BITS, mode->greenBits);
   glfwWindowHint(GLFW_BLUE_BITS, mode->blueBits);
@@ -283,6 +287,17 @@ GLFWContext &GLFWContext::matchPrimaryMonitorVideoMode() {
   return *this;
 }
 
+GLFWContext &GLFWContext::windowVisible(bool value) {
+  glfwWindowHint(GLFW_VISIBLE, value);
+  return *this;
+}
+
+GLFWContext &GLFWContext::glEGLContextAPI(bool value) {
+  glfwWindowHint(GLFW_CONTEXT_CREATION_API,
+                 value ? GLFW_EGL_CONTEXT_API : GLFW_NATIVE_CONTEXT_API);
+  return *this;
+}
+
 bool GLFWContext::initalize() { return glfwInit(); }
 
 void GLFWContext::shutdown() { glfwTerminate(); }
@@ -243,6 +243,11 @@ public: // interface
   GLFWContext &glCoreProfile();
   GLFWContext &glAntiAliasingSamples(int samples);
   GLFWContext &matchPrimaryMonitorVideoMode();
+  // Windows made after this are hidden; they still have a GL context
+  GLFWContext &windowVisible(bool value);
+  // Contexts made after this are created through EGL rather than GLX/WGL/NSGL,
+  // e.g. for Mesa on servers without a GPU
+  GLFWContext &glEGLContextAPI(bool value);
 
 private: // functions
   bool initalize();
@@ -249,7 +249,7 @@ std::string givr::style::phongVertexSource(std::string modelSource, bool usingTe
         std::string(hasNormals ? "#define HAS_NORMALS\n" : "") +
         std::string(hasColours ? "#define HAS_COLOURS\n" : "") +
         modelSource +
-        std::string(R"shader( mat4 model;
+        std::string(R"shader(
         layout(location=4) in vec3 position;
         #ifdef HAS_NORMALS
             layout(location=5) in vec3 normal;
@@ -261,8 +261,7 @@ std::string givr::style::phongVertexSource(std::string modelSource, bool usingTe
             layout(location=7) in vec3 colour;
         #endif
 
-        uniform mat4 view;
-        uniform mat4 projection;
+        )shader" + givr::cameraBlockSource() + R"shader(
 
         #ifdef HAS_NORMALS
             out vec3 geomNormal;
@@ -379,7 +378,7 @@ std::string givr::style::phongFragmentSource(bool usingTexture, bool hasColours)
         uniform float ambientFactor;
         uniform float specularFactor;
         uniform float phongExponent;
-        uniform vec3 viewPosition;
+        )shader" + givr::cameraBlockSource() + R"shader(
         uniform bool showWireFrame;
         uniform vec3 wireFrameColour;
         uniform float wireFrameWidth;
@@ -458,11 +457,10 @@ using Colour = givr::style::Colour;
 
 std::string givr::style::linesVertexSource(std::string modelSource) {
     std::cout << "modelSource: " << modelSource << std::endl;
-    return "#version 330 core\n" + modelSource + std::string(R"shader( mat4 model;
+    return "#version 330 core\n" + modelSource + std::string(R"shader(
         layout(location=4) in vec3 position;
 
-        uniform mat4 view;
-        uniform mat4 projection;
+        )shader" + givr::cameraBlockSource() + R"shader(
 
         void main(){
             mat4 mvp = projection * view * model;
@@ -498,11 +496,10 @@ std::string givr::style::linesFragmentSource() {
 //------------------------------------------------------------------------------
 
 std::string givr::style::noShadingVertexSource(std::string modelSource) {
-    return "#version 330 core\n" + modelSource + std::string(R"shader( mat4 model;
+    return "#version 330 core\n" + modelSource + std::string(R"shader(
         layout(location=4) in vec3 position;
 
-        uniform mat4 view;
-        uniform mat4 projection;
+        )shader" + givr::cameraBlockSource() + R"shader(
         uniform vec3 colour;
 
         void main()
@@ -532,6 +529,145 @@ std::string givr::style::noShadingFragmentSource() {
 // END noshading.cpp
 //------------------------------------------------------------------------------
 
+//------------------------------------------------------------------------------
+// Start impostor.cpp
+//------------------------------------------------------------------------------
+
+std::string givr::style::sphereImpostorVertexSource(std::string modelSource, bool hasRadii, bool hasColours) {
+    return
+        "#version 330 core\n" +
+        std::string(hasRadii ? "#define HAS_RADII\n" : "") +
+        std::string(hasColours ? "#define HAS_COLOURS\n" : "") +
+        modelSource +
+        std::string(R"shader(
+        layout(location=4) in vec3 position;
+        #ifdef HAS_COLOURS
+            layout(location=7) in vec3 colour;
+        #endif
+        #ifdef HAS_RADII
+            layout(location=8) in float radius;
+        #endif
+
+        )shader" + givr::cameraBlockSource() + R"shader(
+        uniform float pointRadius;
+        uniform vec4 viewport;
+
+        out vec3 fragCentre;
+        out float fragRadius;
+        #ifdef HAS_COLOURS
+            out vec3 fragColour;
+        #endif
+
+        void main(){
+            #ifdef HAS_RADII
+                // An empty radius stream leaves the attribute disabled, which
+                // reads as zero.
+                fragRadius = radius > 0.0 ? radius : pointRadius;
+            #else
+                fragRadius = pointRadius;
+            #endif
+            vec4 centre = view * model * vec4(position, 1.0);
+            fragCentre = centre.xyz;
+            gl_Position = projection * centre;
+
+            // Under perspective the sphere's silhouette is wider than its
+            // radius at the centre's depth, so the sprite is sized against
+            // the nearest point of the sphere instead.
+            float w = gl_Position.w;
+            if (projection[3][3] == 0.0) {
+                w = max(w - fragRadius, 1e-3);
+            }
+            gl_PointSize = fragRadius * projection[1][1] * viewport.w / w + 2.0;
+            #ifdef HAS_COLOURS
+                fragColour = colour;
+            #endif
+        }
+
+        )shader"
+    );
+}
+
+std::string givr::style::sphereImpostorFragmentSource(bool hasColours) {
+    return
+        "#version 330 core\n" +
+        std::string(hasColours ? "#define HAS_COLOURS\n" : "") +
+        std::string(R"shader(
+        #define M_PI 3.1415926535897932384626433832795
+
+        )shader" + givr::cameraBlockSource() + R"shader(
+        uniform mat4 inverseProjection;
+        uniform vec4 viewport;
+        uniform vec3 colour;
+        uniform bool perVertexColour;
+        uniform vec3 lightPosition;
+        uniform float ambientFactor;
+        uniform float specularFactor;
+        uniform float phongExponent;
+
+        in vec3 fragCentre;
+        in float fragRadius;
+        #ifdef HAS_COLOURS
+            in vec3 fragColour;
+        #endif
+
+        out vec4 outColour;
+
+        void main()
+        {
+            // Ray through this pixel in view space. Unprojecting both ends
+            // handles perspective and orthographic cameras alike.
+            vec2 ndc = 2.0 * (gl_FragCoord.xy - viewport.xy) / viewport.zw - 1.0;
+            vec4 near = inverseProjection * vec4(ndc, -1.0, 1.0);
+            vec4 far = inverseProjection * vec4(ndc, 1.0, 1.0);
+            vec3 origin = near.xyz / near.w;
+            vec3 direction = normalize(far.xyz / far.w - origin);
+
+            vec3 oc = origin - fragCentre;
+            float b = dot(oc, direction);
+            float c = dot(oc, oc) - fragRadius * fragRadius;
+            float discriminant = b * b - c;
+            if (discriminant < 0.0) {
+                discard;
+            }
+            vec3 position = origin + (-b - sqrt(discriminant)) * direction;
+            vec3 normal = (position - fragCentre) / fragRadius;
+
+            vec4 clip = projection * vec4(position, 1.0);
+            gl_FragDepth = 0.5 * (gl_DepthRange.diff * (clip.z / clip.w) +
+                                  gl_DepthRange.near + gl_DepthRange.far);
+
+            vec3 finalColour = colour;
+            #ifdef HAS_COLOURS
+                if (perVertexColour) {
+                    finalColour = fragColour;
+                }
+            #endif
+
+            // ambient
+            vec3 ambient = ambientFactor * finalColour;
+
+            // diffuse
+            vec3 lightDirection = normalize(vec3(view * vec4(lightPosition, 1.0)) - position);
+            float diff = max(dot(lightDirection, normal), 0.0);
+            vec3 diffuse = diff * finalColour;
+
+            // specular
+            vec3 viewDirection = -direction;
+            vec3 reflectDirection = normalize(2.0*dot(lightDirection, normal)*normal - lightDirection);
+            float normalization = (phongExponent+2.0)/(2.0*M_PI);
+            float spec = normalization*diff*pow(max(dot(viewDirection, reflectDirection), 0.0), phongExponent);
+            vec3 specular = vec3(specularFactor) * spec; // assuming bright white light colour
+
+            outColour = vec4(ambient + diffuse + specular, 1.0);
+        }
+
+        )shader"
+    );
+}
+//------------------------------------------------------------------------------
+// END impostor.cpp
+//------------------------------------------------------------------------------
+
 //------------------------------------------------------------------------------
 // Start cylinder.cpp
 //------------------------------------------------------------------------------
@@ -713,6 +849,22 @@ MultiLineGeometry::Data givr::geometry::generateGeometry(MultiLineGeometry const
 // END multiline.cpp
 //------------------------------------------------------------------------------
 
+//------------------------------------------------------------------------------
+// Start line_segments.cpp
+//------------------------------------------------------------------------------
+
+using LineSegments = givr::geometry::LineSegments;
+
+LineSegments::Data givr::geometry::generateGeometry(LineSegments const &l) {
+    LineSegments::Data data;
+    data.vertices = gsl::span<const float>(
+        reinterpret_cast<float const *>(l.vertices().data()), l.vertices().size() * 3);
+    return data;
+}
+//------------------------------------------------------------------------------
+// END line_segments.cpp
+//------------------------------------------------------------------------------
+
 //------------------------------------------------------------------------------
 // Start triangle.cpp
 //------------------------------------------------------------------------------
@@ -965,6 +1117,231 @@ TriangleSoupGeometry::Data givr::geometry::generateGeometry(TriangleSoupGeometry
 // END triangle_soup.cpp
 //------------------------------------------------------------------------------
 
+//------------------------------------------------------------------------------
+// Start parallel.cpp
+//------------------------------------------------------------------------------
+
+using WorkerPool = givr::WorkerPool;
+
+WorkerPool::WorkerPool(std::size_t workers) {
+    m_workers.reserve(workers);
+    for (std::size_t i = 0; i < workers; ++i) {
+        m_workers.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (auto &worker : m_workers) {
+        worker.join();
+    }
+}
+
+WorkerPool &WorkerPool::instance() {
+    static WorkerPool pool(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+    return pool;
+}
+
+void WorkerPool::run(std::size_t count, std::size_t grain, Task task, void const *body) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task = task;
+        m_body = body;
+        m_count = count;
+        m_grain = grain;
+        m_next = 0;
+        m_busy = m_workers.size();
+        ++m_generation;
+    }
+    m_wake.notify_all();
+    work();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this]() { return m_busy == 0; });
+}
+
+void WorkerPool::work() {
+    for (;;) {
+        std::size_t begin = m_next.fetch_add(m_grain);
+        if (begin >= m_count) {
+            return;
+        }
+        m_task(m_body, begin, std::min(begin + m_grain, m_count));
+    }
+}
+
+void WorkerPool::workerLoop() {
+    std::uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_wake.wait(lock, [&]() { return m_stop || m_generation != seen; });
+        if (m_stop) {
+            return;
+        }
+        seen = m_generation;
+        lock.unlock();
+        work();
+        lock.lock();
+        if (--m_busy == 0) {
+            m_done.notify_one();
+        }
+    }
+}
+//------------------------------------------------------------------------------
+// END parallel.cpp
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// Start surface_mesh.cpp
+//------------------------------------------------------------------------------
+
+#include <atomic>
+
+using SurfaceMesh = givr::geometry::SurfaceMesh;
+
+namespace {
+    // Shared between all meshes so that a render context can never mistake
+    // one mesh's connectivity for another's. Atomic, since geometry can be
+    // built on threads other than the GL one.
+    std::uint64_t nextIndicesRevision() {
+        static std::atomic<std::uint64_t> revision{0};
+        return revision.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+}
+
+void SurfaceMesh::setIndices(std::vector<std::uint32_t> indices) {
+    m_indices = std::move(indices);
+    m_indicesRevision = nextIndicesRevision();
+    m_vertexTriangleOffsets.clear();
+}
+
+void SurfaceMesh::buildVertexTriangles(std::size_t vertexCount) {
+    std::size_t triangleCount = m_indices.size() / 3;
+    assert(std::all_of(m_indices.begin(), m_indices.end(),
+        [=](std::uint32_t i) { return i < vertexCount; }));
+    m_vertexTriangleOffsets.assign(vertexCount + 1, 0);
+    for (std::size_t t = 0; t < triangleCount * 3; ++t) {
+        ++m_vertexTriangleOffsets[m_indices[t] + 1];
+    }
+    for (std::size_t v = 0; v < vertexCount; ++v) {
+        m_vertexTriangleOffsets[v + 1] += m_vertexTriangleOffsets[v];
+    }
+    m_vertexTriangles.resize(m_vertexTriangleOffsets[vertexCount]);
+    std::vector<std::uint32_t> cursor(m_vertexTriangleOffsets.begin(), m_vertexTriangleOffsets.end() - 1);
+    for (std::size_t t = 0; t < triangleCount * 3; ++t) {
+        m_vertexTriangles[cursor[m_indices[t]]++] = std::uint32_t(t / 3);
+    }
+}
+
+void SurfaceMesh::computeNormals() {
+    constexpr std::size_t grain = 4096;
+    std::size_t vertexCount = m_vertices.size();
+    std::size_t triangleCount = m_indices.size() / 3;
+    if (m_vertexTriangleOffsets.size() != vertexCount + 1) {
+        buildVertexTriangles(vertexCount);
+    }
+    m_faceNormals.resize(triangleCount);
+    m_normals.resize(vertexCount);
+
+    // Face normals. The cross product's length is twice the triangle's
+    // area, which weights each face by its size.
+    vec3f const *vertices = m_vertices.data();
+    std::uint32_t const *indices = m_indices.data();
+    vec3f *faceNormals = m_faceNormals.data();
+    givr::parallelFor(triangleCount, grain, [=](std::size_t begin, std::size_t end) {
+        for (std::size_t t = begin; t < end; ++t) {
+            vec3f const p1 = vertices[indices[3 * t]];
+            vec3f const p2 = vertices[indices[3 * t + 1]];
+            vec3f const p3 = vertices[indices[3 * t + 2]];
+            faceNormals[t] = glm::cross(p2 - p1, p3 - p1);
+        }
+    });
+
+    // Each vertex gathers the faces around it, so no two threads write the
+    // same normal.
+    std::uint32_t const *offsets = m_vertexTriangleOffsets.data();
+    std::uint32_t const *triangles = m_vertexTriangles.data();
+    vec3f *normals = m_normals.data();
+    givr::parallelFor(vertexCount, grain, [=](std::size_t begin, std::size_t end) {
+        for (std::size_t v = begin; v < end; ++v) {
+            vec3f sum(0.f);
+            for (std::uint32_t f = offsets[v]; f < offsets[v + 1]; ++f) {
+                sum += faceNormals[triangles[f]];
+            }
+            float length2 = glm::dot(sum, sum);
+            normals[v] = length2 > 0.f ? sum * (1.f / std::sqrt(length2)) : sum;
+        }
+    });
+}
+
+SurfaceMesh::Data givr::geometry::generateGeometry(SurfaceMesh const &m) {
+    SurfaceMesh::Data data;
+    data.indicesRevision = m.indicesRevision();
+    data.vertices = gsl::span<const float>(
+        reinterpret_cast<float const *>(m.vertices().data()), m.vertices().size() * 3);
+    data.normals = gsl::span<const float>(
+        reinterpret_cast<float const *>(m.normals().data()), m.normals().size() * 3);
+    data.indices = gsl::span<const std::uint32_t>(m.indices());
+    return data;
+}
+//------------------------------------------------------------------------------
+// END surface_mesh.cpp
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// Start spring_network.cpp
+//------------------------------------------------------------------------------
+
+using SpringNetwork = givr::geometry::SpringNetwork;
+
+void SpringNetwork::setIndices(std::vector<std::uint32_t> indices) {
+    assert(indices.size() % 2 == 0);
+    m_indices = std::move(indices);
+    m_indicesRevision = nextIndicesRevision();
+}
+
+SpringNetwork::Data givr::geometry::generateGeometry(SpringNetwork const &n) {
+    SpringNetwork::Data data;
+    data.indicesRevision = n.indicesRevision();
+    data.vertices = gsl::span<const float>(
+        reinterpret_cast<float const *>(n.vertices().data()), n.vertices().size() * 3);
+    data.indices = gsl::span<const std::uint32_t>(n.indices());
+    return data;
+}
+//------------------------------------------------------------------------------
+// END spring_network.cpp
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// Start point_cloud.cpp
+//------------------------------------------------------------------------------
+
+using PointCloud = givr::geometry::PointCloud;
+
+void PointCloud::setIndices(std::vector<std::uint32_t> indices) {
+    m_indices = std::move(indices);
+    m_indicesRevision = nextIndicesRevision();
+}
+
+PointCloud::Data givr::geometry::generateGeometry(PointCloud const &p) {
+    PointCloud::Data data;
+    data.indicesRevision = p.indicesRevision();
+    data.indices = gsl::span<const std::uint32_t>(p.indices());
+    data.vertices = gsl::span<const float>(
+        reinterpret_cast<float const *>(p.vertices().data()), p.vertices().size() * 3);
+    data.radii = gsl::span<const float>(p.radii());
+    data.colours = gsl::span<const float>(
+        reinterpret_cast<float const *>(p.colours().data()), p.colours().size() * 3);
+    return data;
+}
+//------------------------------------------------------------------------------
+// END point_cloud.cpp
+//------------------------------------------------------------------------------
+
 //------------------------------------------------------------------------------
 // Start quad.cpp
 //------------------------------------------------------------------------------
@@ -1032,14 +1409,282 @@ LineGeometry::Data givr::geometry::generateGeometry(LineGeometry const &l) {
 // END line.cpp
 //------------------------------------------------------------------------------
 
+//------------------------------------------------------------------------------
+// Start camera_block.cpp
+//------------------------------------------------------------------------------
+#include <cstring>
+
+std::string givr::cameraBlockSource() {
+    return std::string(R"shader(
+        layout(std140) uniform Camera {
+            mat4 view;
+            mat4 projection;
+            vec3 viewPosition;
+        };
+        )shader"
+    );
+}
+
+void givr::updateCameraBlock(mat4f const &view, mat4f const &projection, vec3f const &viewPosition) {
+    // One buffer for the process, in the one GL context givr renders to. It
+    // is left for the context to clean up rather than deleted at exit, when
+    // the context may already be gone.
+    static GLuint buffer = 0;
+    static CameraBlock current;
+
+    CameraBlock block{view, projection, vec4f(viewPosition, 1.f)};
+    if (!buffer) {
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(CameraBlock), &block, GL_DYNAMIC_DRAW);
+        glBindBufferBase(GL_UNIFORM_BUFFER, CAMERA_BLOCK_BINDING, buffer);
+    } else if (std::memcmp(&block, &current, sizeof(CameraBlock)) != 0) {
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(CameraBlock), &block);
+    } else {
+        return;
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    current = block;
+}
+//------------------------------------------------------------------------------
+// END camera_block.cpp
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// Start stats.cpp
+//------------------------------------------------------------------------------
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <vector>
+
+using FrameStats = givr::stats::FrameStats;
+
+namespace {
+    // The queries issued during one frame, per timer.
+    struct QuerySet {
+        std::array<std::vector<GLuint>, 2> queries;
+        std::array<std::size_t, 2> used{};
+        std::uint64_t frame = 0;
+    };
+
+    struct StatsState {
+        bool gpuTiming = false;
+        bool inFrame = false;
+        bool timerActive = false;
+        std::uint64_t frame = 0;
+        FrameStats current;
+        std::array<FrameStats, givr::stats::HISTORY_LENGTH> history;
+        std::size_t historySize = 0;
+        std::array<QuerySet, givr::stats::QUERY_FRAMES> querySets;
+    };
+
+    // Left for the GL context to clean up, like the camera block.
+    StatsState &statsState() {
+        static StatsState *s = new StatsState();
+        return *s;
+    }
+
+    FrameStats &historyEntry(StatsState &s, std::uint64_t frame) {
+        return s.history[frame % givr::stats::HISTORY_LENGTH];
+    }
+
+    // Reads back a finished frame's queries, or drops them if the GPU is
+    // somehow still behind; waiting for them would stall.
+    void resolve(StatsState &s, QuerySet &set) {
+        std::array<double, 2> ms{};
+        bool available = true;
+        for (std::size_t t = 0; t < set.queries.size(); ++t) {
+            if (set.used[t] == 0) {
+                continue;
+            }
+            GLint ready = 0;
+            glGetQueryObjectiv(set.queries[t][set.used[t] - 1], GL_QUERY_RESULT_AVAILABLE, &ready);
+            if (!ready) {
+                available = false;
+                break;
+            }
+            for (std::size_t q = 0; q < set.used[t]; ++q) {
+                GLuint64 ns = 0;
+                glGetQueryObjectui64v(set.queries[t][q], GL_QUERY_RESULT, &ns);
+                ms[t] += double(ns) * 1e-6;
+            }
+        }
+        bool issued = set.used[0] > 0 || set.used[1] > 0;
+        set.used = {};
+        FrameStats &entry = historyEntry(s, set.frame);
+        if (!issued || !available || entry.frame != set.frame) {
+            return;
+        }
+        entry.gpuDrawMs = ms[std::size_t(givr::stats::Timer::Draw)];
+        entry.gpuUploadMs = ms[std::size_t(givr::stats::Timer::Upload)];
+        entry.gpuTimeValid = true;
+    }
+}
+
+void givr::stats::setGpuTimingEnabled(bool enabled) {
+    statsState().gpuTiming = enabled;
+}
+
+bool givr::stats::gpuTimingEnabled() {
+    return statsState().gpuTiming;
+}
+
+void givr::stats::beginFrame() {
+    StatsState &s = statsState();
+    QuerySet &set = s.querySets[s.frame % QUERY_FRAMES];
+    resolve(s, set);
+    set.frame = s.frame;
+    s.current = FrameStats();
+    s.current.frame = s.frame;
+    s.inFrame = true;
+}
+
+void givr::stats::endFrame() {
+    StatsState &s = statsState();
+    historyEntry(s, s.frame) = s.current;
+    s.historySize = std::min(s.historySize + 1, HISTORY_LENGTH);
+    s.inFrame = false;
+    ++s.frame;
+}
+
+FrameStats const &givr::stats::current() {
+    return statsState().current;
+}
+
+FrameStats const &givr::stats::history(std::size_t framesAgo) {
+    StatsState &s = statsState();
+    assert(framesAgo < s.historySize);
+    return historyEntry(s, s.frame - 1 - framesAgo);
+}
+
+std::size_t givr::stats::historySize() {
+    return statsState().historySize;
+}
+
+void givr::stats::recordDraw(std::uint64_t vertices, std::uint64_t instances) {
+    FrameStats &frame = statsState().current;
+    ++frame.draws;
+    frame.vertices += vertices;
+    frame.instances += instances;
+}
+
+void givr::stats::recordUpload(std::uint64_t bytes) {
+    FrameStats &frame = statsState().current;
+    ++frame.uploads;
+    frame.bytesUploaded += bytes;
+}
+
+givr::stats::ScopedGpuTimer::ScopedGpuTimer(Timer timer)
+    : m_active(false)
+{
+    StatsState &s = statsState();
+    if (!s.gpuTiming || !s.inFrame || s.timerActive) {
+        return;
+    }
+    QuerySet &set = s.querySets[s.frame % QUERY_FRAMES];
+    std::vector<GLuint> &queries = set.queries[std::size_t(timer)];
+    std::size_t &used = set.used[std::size_t(timer)];
+    if (used == queries.size()) {
+        GLuint query = 0;
+        glGenQueries(1, &query);
+        queries.push_back(query);
+    }
+    glBeginQuery(GL_TIME_ELAPSED, queries[used++]);
+    s.timerActive = true;
+    m_active = true;
+}
+
+givr::stats::ScopedGpuTimer::~ScopedGpuTimer() {
+    if (m_active) {
+        glEndQuery(GL_TIME_ELAPSED);
+        statsState().timerActive = false;
+    }
+}
+//------------------------------------------------------------------------------
+// END stats.cpp
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// Start instance_layout.cpp
+//------------------------------------------------------------------------------
+
+// Each layout declares the `model` the style shaders multiply by. Layouts
+// without a full matrix rebuild it per vertex from their instance attributes.
+
+std::string givr::instancing::Transform::modelSource() {
+    return "layout(location=0) in mat4 model;\n";
+}
+
+std::string givr::instancing::Offset::modelSource() {
+    return std::string(R"shader(
+        layout(location=0) in vec3 instanceOffset;
+
+        mat4 instanceModel() {
+            return mat4(1.0, 0.0, 0.0, 0.0,
+                        0.0, 1.0, 0.0, 0.0,
+                        0.0, 0.0, 1.0, 0.0,
+                        instanceOffset, 1.0);
+        }
+        #define model instanceModel()
+        )shader"
+    );
+}
+
+std::string givr::instancing::OffsetScale::modelSource() {
+    return std::string(R"shader(
+        layout(location=0) in vec4 instanceOffsetScale;
+
+        mat4 instanceModel() {
+            float s = instanceOffsetScale.w;
+            return mat4(s, 0.0, 0.0, 0.0,
+                        0.0, s, 0.0, 0.0,
+                        0.0, 0.0, s, 0.0,
+                        instanceOffsetScale.xyz, 1.0);
+        }
+        #define model instanceModel()
+        )shader"
+    );
+}
+
+std::string givr::instancing::OffsetRotation::modelSource() {
+    return std::string(R"shader(
+        layout(location=0) in vec3 instanceOffset;
+        layout(location=1) in vec4 instanceRotation;
+
+        mat4 instanceModel() {
+            vec4 q = instanceRotation;
+            vec3 q2 = q.xyz + q.xyz;
+            float xx = q.x * q2.x, yy = q.y * q2.y, zz = q.z * q2.z;
+            float xy = q.x * q2.y, xz = q.x * q2.z, yz = q.y * q2.z;
+            float wx = q.w * q2.x, wy = q.w * q2.y, wz = q.w * q2.z;
+            return mat4(1.0 - (yy + zz), xy + wz, xz - wy, 0.0,
+                        xy - wz, 1.0 - (xx + zz), yz + wx, 0.0,
+                        xz + wy, yz - wx, 1.0 - (xx + yy), 0.0,
+                        instanceOffset, 1.0);
+        }
+        #define model instanceModel()
+        )shader"
+    );
+}
+//------------------------------------------------------------------------------
+// END instance_layout.cpp
+//------------------------------------------------------------------------------
+
 //------------------------------------------------------------------------------
 // Start program.cpp
 //------------------------------------------------------------------------------
 #include <glm/gtc/type_ptr.hpp>
 
+#include <algorithm>
+#include <cstring>
+
 using Program = givr::Program;
+using givr::UniformHandle;
 using vec2f = givr::vec2f;
 using vec3f = givr::vec3f;
+using vec4f = givr::vec4f;
 using mat4f = givr::mat4f;
 
 Program::Program(
@@ -1064,8 +1709,19 @@ Program::Program(
     linkAndErrorCheck();
 }
 
+Program::Program(
+    GLuint program
+) : m_programID{program}
+{
+    resolveUniforms();
+}
+
 void Program::linkAndErrorCheck() {
 
+    // Lets the program cache read the binary back (GL 4.1).
+    if (glad_glProgramParameteri) {
+        glProgramParameteri(m_programID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
     glLinkProgram(m_programID);
     GLint success;
     glGetProgramiv(m_programID, GL_LINK_STATUS, &success);
@@ -1077,6 +1733,50 @@ void Program::linkAndErrorCheck() {
         // TODO(lw): Consider a better exception here
         throw std::runtime_error(out.str());
     }
+    resolveUniforms();
+}
+
+void Program::resolveUniforms() {
+    GLint count = 0;
+    GLint maxLength = 0;
+    glGetProgramiv(m_programID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(m_programID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    std::vector<GLchar> name(std::max(maxLength, 1));
+    m_uniformLocations.clear();
+    for (GLint i = 0; i < count; ++i) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(m_programID, GLuint(i), GLsizei(name.size()), &length, &size, &type, name.data());
+        GLint location = glGetUniformLocation(m_programID, name.data());
+        // Uniforms inside blocks have no location.
+        if (location == -1) {
+            continue;
+        }
+        std::string uniformName(name.data(), length);
+        // Arrays are reported as name[0]; look them up by their plain name.
+        if (uniformName.size() > 3 && uniformName.compare(uniformName.size() - 3, 3, "[0]") == 0) {
+            uniformName.resize(uniformName.size() - 3);
+        }
+        m_uniformLocations.emplace_back(std::move(uniformName), location);
+    }
+    std::sort(m_uniformLocations.begin(), m_uniformLocations.end());
+
+    GLuint cameraBlock = glGetUniformBlockIndex(m_programID, "Camera");
+    if (cameraBlock != GL_INVALID_INDEX) {
+        glUniformBlockBinding(m_programID, cameraBlock, givr::CAMERA_BLOCK_BINDING);
+    }
+}
+
+GLint Program::uniformLocation(const char *name) const {
+    auto it = std::lower_bound(m_uniformLocations.begin(), m_uniformLocations.end(), name,
+        [](std::pair<std::string, GLint> const &entry, const char *n) {
+            return std::strcmp(entry.first.c_str(), n) < 0;
+        });
+    if (it == m_uniformLocations.end() || std::strcmp(it->first.c_str(), name) != 0) {
+        return -1;
+    }
+    return it->second;
 }
 
 Program::~Program() {
@@ -1087,30 +1787,62 @@ void Program::use() {
     glUseProgram(m_programID);
 }
 
-void Program::setVec2(const std::string &name, vec2f const &value) const
+void Program::set(UniformHandle<vec2f> handle, vec2f const &value) const
+{
+    glUniform2fv(handle.location, 1, value_ptr(value));
+}
+void Program::set(UniformHandle<vec3f> handle, vec3f const &value) const
+{
+    glUniform3fv(handle.location, 1, value_ptr(value));
+}
+void Program::set(UniformHandle<vec4f> handle, vec4f const &value) const
 {
-    glUniform2fv(glGetUniformLocation(m_programID, name.c_str()), 1, value_ptr(value));
+    glUniform4fv(handle.location, 1, value_ptr(value));
 }
-void Program::setVec3(const std::string &name, vec3f const &value) const
+void Program::set(UniformHandle<mat4f> handle, mat4f const &mat) const
 {
-    glUniform3fv(glGetUniformLocation(m_programID, name.c_str()), 1, value_ptr(value));
+    glUniformMatrix4fv(handle.location, 1, GL_FALSE, value_ptr(mat));
 }
-void Program::setMat4(const std::string &name, mat4f const &mat) const
+void Program::set(UniformHandle<bool> handle, bool value) const
 {
-    glUniformMatrix4fv(glGetUniformLocation(m_programID, name.c_str()), 1, GL_FALSE, value_ptr(mat));
+    glUniform1i(handle.location, static_cast<int>(value));
 }
-void Program::setBool(const std::string &name, bool value) const
+void Program::set(UniformHandle<float> handle, float value) const
 {
-    glUniform1i(glGetUniformLocation(m_programID, name.c_str()), static_cast<int>(value));
+    glUniform1f(handle.location, value);
 }
-void Program::setFloat(const std::string &name, float value) const
+void Program::set(UniformHandle<int> handle, int value) const
 {
-    glUniform1f(glGetUniformLocation(m_programID, name.c_str()), value);
+    glUniform1i(handle.location, value);
 }
 
-void Program::setInt(const std::string &name, int value) const
+void Program::setVec2(const char *name, vec2f const &value) const
+{
+    set(uniform<vec2f>(name), value);
+}
+void Program::setVec3(const char *name, vec3f const &value) const
+{
+    set(uniform<vec3f>(name), value);
+}
+void Program::setVec4(const char *name, vec4f const &value) const
+{
+    set(uniform<vec4f>(name), value);
+}
+void Program::setMat4(const char *name, mat4f const &mat) const
+{
+    set(uniform<mat4f>(name), mat);
+}
+void Program::setBool(const char *name, bool value) const
+{
+    set(uniform<bool>(name), value);
+}
+void Program::setFloat(const char *name, float value) const
 {
-	glUniform1i(glGetUniformLocation(m_programID, name.c_str()), value);
+    set(uniform<float>(name), value);
+}
+void Program::setInt(const char *name, int value) const
+{
+    set(uniform<int>(name), value);
 }
 
 /*
@@ -1130,10 +1862,6 @@ void Program::setVec3(const std::string &name, float x, float y, float z) const
 {
     glUniform3f(glGetUniformLocation(m_programID, name.c_str()), x, y, z);
 }
-void Program::setVec4(const std::string &name, const glm::vec4 &value) const
-{
-    glUniform4fv(glGetUniformLocation(m_programID, name.c_str()), 1, glm::value_ptr(value));
-}
 void Program::setVec4(const std::string &name, float x, float y, float z, float w)
 {
     glUniform4f(glGetUniformLocation(m_programID, name.c_str()), x, y, z, w);
@@ -1151,6 +1879,220 @@ void Program::setMat3(const std::string &name, const glm::mat3 &mat) const
 // END program.cpp
 //------------------------------------------------------------------------------
 
+//------------------------------------------------------------------------------
+// Start program_cache.cpp
+//------------------------------------------------------------------------------
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    struct ProgramCache {
+        // Keyed by the sources themselves, so two programs can never collide.
+        std::unordered_map<std::string, std::shared_ptr<givr::Program>> programs;
+        std::string directory;
+    };
+
+    std::string defaultProgramCacheDirectory() {
+        if (const char *dir = std::getenv("GIVR_PROGRAM_CACHE")) {
+            return dir;
+        }
+        if (const char *dir = std::getenv("XDG_CACHE_HOME")) {
+            return std::string(dir) + "/givr";
+        }
+        if (const char *dir = std::getenv("HOME")) {
+            return std::string(dir) + "/.cache/givr";
+        }
+        if (const char *dir = std::getenv("LOCALAPPDATA")) {
+            return std::string(dir) + "/givr";
+        }
+        return "";
+    }
+
+    // The programs belong to the GL context, which is gone by the time static
+    // destructors run, so the cache is deliberately never destroyed.
+    ProgramCache &programCache() {
+        static ProgramCache *cache = new ProgramCache{{}, defaultProgramCacheDirectory()};
+        return *cache;
+    }
+
+    // 64-bit FNV-1a
+    std::uint64_t hashSource(std::string const &source) {
+        std::uint64_t hash = 0xcbf29ce484222325ull;
+        for (unsigned char c : source) {
+            hash ^= c;
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    std::string driverString() {
+        auto get = [](GLenum name) {
+            const GLubyte *value = glGetString(name);
+            return value ? std::string(reinterpret_cast<const char *>(value)) : std::string();
+        };
+        return get(GL_VENDOR) + "\n" + get(GL_RENDERER) + "\n" + get(GL_VERSION);
+    }
+
+    bool programBinariesSupported() {
+        if (!glad_glGetProgramBinary || !glad_glProgramBinary) {
+            return false;
+        }
+        GLint formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        return formats > 0;
+    }
+
+    // File layout: magic, source hash, driver length, binary format, binary
+    // length, then the driver string and the binary itself.
+    constexpr char programBinaryMagic[8] = {'G', 'I', 'V', 'R', 'P', 'R', 'G', '1'};
+
+    struct ProgramBinaryHeader {
+        char magic[8];
+        std::uint64_t sourceHash;
+        std::uint32_t driverLength;
+        std::uint32_t binaryFormat;
+        std::uint32_t binaryLength;
+    };
+
+    std::shared_ptr<givr::Program> loadProgramBinary(
+        std::filesystem::path const &path, std::uint64_t sourceHash, std::string const &driver)
+    {
+        std::ifstream in(path, std::ios::binary);
+        ProgramBinaryHeader header;
+        if (!in.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+            !std::equal(std::begin(programBinaryMagic), std::end(programBinaryMagic), header.magic) ||
+            header.sourceHash != sourceHash || header.driverLength != driver.size()) {
+            return nullptr;
+        }
+        std::string fileDriver(header.driverLength, '\0');
+        std::vector<char> binary(header.binaryLength);
+        if (!in.read(&fileDriver[0], fileDriver.size()) || fileDriver != driver ||
+            !in.read(binary.data(), binary.size())) {
+            return nullptr;
+        }
+
+        GLuint program = glCreateProgram();
+        glProgramBinary(program, header.binaryFormat, binary.data(), GLsizei(binary.size()));
+        GLint success = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success) {
+            // Rejected by the driver, e.g. after an update that kept its
+            // version string; fall back to compiling.
+            glDeleteProgram(program);
+            return nullptr;
+        }
+        return std::make_shared<givr::Program>(program);
+    }
+
+    void saveProgramBinary(
+        std::filesystem::path const &path, std::uint64_t sourceHash, std::string const &driver,
+        givr::Program const &program)
+    {
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0) {
+            return;
+        }
+        std::vector<char> binary(length);
+        GLenum format = 0;
+        glGetProgramBinary(program, length, &length, &format, binary.data());
+
+        ProgramBinaryHeader header;
+        std::copy(std::begin(programBinaryMagic), std::end(programBinaryMagic), header.magic);
+        header.sourceHash = sourceHash;
+        header.driverLength = std::uint32_t(driver.size());
+        header.binaryFormat = format;
+        header.binaryLength = std::uint32_t(length);
+
+        // Written beside the final name and renamed into place, so a reader
+        // never sees a partial file.
+        std::error_code error;
+        std::filesystem::create_directories(path.parent_path(), error);
+        std::filesystem::path temporary = path;
+        temporary += ".tmp";
+        {
+            std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+            out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            out.write(driver.data(), driver.size());
+            out.write(binary.data(), length);
+            if (!out) {
+                return;
+            }
+        }
+        std::filesystem::rename(temporary, path, error);
+    }
+
+    template <typename Compile>
+    std::shared_ptr<givr::Program> cachedProgram(std::string key, Compile compile) {
+        ProgramCache &cache = programCache();
+        auto found = cache.programs.find(key);
+        if (found != cache.programs.end()) {
+            return found->second;
+        }
+
+        std::shared_ptr<givr::Program> program;
+        bool useDisk = !cache.directory.empty() && programBinariesSupported();
+        std::uint64_t sourceHash = hashSource(key);
+        std::filesystem::path path;
+        std::string driver;
+        if (useDisk) {
+            char name[32];
+            std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(sourceHash));
+            path = std::filesystem::path(cache.directory) / name;
+            driver = driverString();
+            program = loadProgramBinary(path, sourceHash, driver);
+        }
+        if (!program) {
+            program = compile();
+            if (useDisk) {
+                saveProgramBinary(path, sourceHash, driver, *program);
+            }
+        }
+        cache.programs.emplace(std::move(key), program);
+        return program;
+    }
+}
+
+std::shared_ptr<givr::Program> givr::getProgram(
+    std::string const &vertexSource,
+    std::string const &fragmentSource
+) {
+    return cachedProgram(vertexSource + '\0' + fragmentSource, [&] {
+        return std::make_shared<Program>(
+            Shader{vertexSource, GL_VERTEX_SHADER},
+            Shader{fragmentSource, GL_FRAGMENT_SHADER});
+    });
+}
+
+std::shared_ptr<givr::Program> givr::getProgram(
+    std::string const &vertexSource,
+    std::string const &geometrySource,
+    std::string const &fragmentSource
+) {
+    return cachedProgram(vertexSource + '\0' + geometrySource + '\0' + fragmentSource, [&] {
+        return std::make_shared<Program>(
+            Shader{vertexSource, GL_VERTEX_SHADER},
+            Shader{geometrySource, GL_GEOMETRY_SHADER},
+            Shader{fragmentSource, GL_FRAGMENT_SHADER});
+    });
+}
+
+void givr::setProgramCacheDirectory(std::string directory) {
+    programCache().directory = std::move(directory);
+}
+
+std::string const &givr::programCacheDirectory() {
+    return programCache().directory;
+}
+//------------------------------------------------------------------------------
+// END program_cache.cpp
+//------------------------------------------------------------------------------
+
 //------------------------------------------------------------------------------
 // Start shader.cpp
 //------------------------------------------------------------------------------
@@ -1308,6 +2250,8 @@ Buffer::Buffer(
 void Buffer::alloc() {
     dealloc();
     glGenBuffers(1, &m_bufferID);
+    m_capacity = 0;
+    m_usage = 0;
 }
 void Buffer::dealloc() {
     if (m_bufferID) {
@@ -1315,6 +2259,20 @@ void Buffer::dealloc() {
     }
 }
 
+void Buffer::upload(GLenum target, GLsizeiptr size, const void *data, GLenum usage) {
+    givr::stats::ScopedGpuTimer timer(givr::stats::Timer::Upload);
+    givr::stats::recordUpload(size);
+    if (size <= m_capacity && usage == m_usage) {
+        if (size > 0) {
+            glBufferSubData(target, 0, size, data);
+        }
+        return;
+    }
+    glBufferData(target, size, data, usage);
+    m_capacity = size;
+    m_usage = usage;
+}
+
 void Buffer::bind(GLenum target) {
     glBindBuffer(target, m_bufferID);
 }
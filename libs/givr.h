@@ -265,6 +265,18 @@ struct hasColours<T, decltype((void)T::Data::colours, 0)> : std::true_type {};
 template <typename T, typename = int> struct hasUvs : std::false_type {};
 template <typename T>
 struct hasUvs<T, decltype((void)T::Data::uvs, 0)> : std::true_type {};
+
+// Checking for per-point radii
+template <typename T, typename = int> struct hasRadii : std::false_type {};
+template <typename T>
+struct hasRadii<T, decltype((void)T::Data::radii, 0)> : std::true_type {};
+
+// Checking for a revision number on the indices
+template <typename T, typename = int>
+struct hasIndicesRevision : std::false_type {};
+template <typename T>
+struct hasIndicesRevision<T, decltype((void)T::Data::indicesRevision, 0)>
+    : std::true_type {};
 }; // namespace givr
 //------------------------------------------------------------------------------
 // END static_assert.h
@@ -11802,6 +11814,125 @@ ViewContext<CameraT, ProjectionT> View(CameraT const &camera,
 // END view_context.h
 //------------------------------------------------------------------------------
 
+//------------------------------------------------------------------------------
+// Start camera_block.h
+//------------------------------------------------------------------------------
+
+#include <string>
+
+//------------------------------------------------------------------------------
+// The camera uniforms shared by every program. They live in one std140
+// uniform buffer bound at CAMERA_BLOCK_BINDING, so a new view is uploaded
+// once rather than set on every program for every draw.
+//------------------------------------------------------------------------------
+namespace givr {
+
+constexpr GLuint CAMERA_BLOCK_BINDING = 0;
+
+// Mirrors the std140 layout of the Camera block in cameraBlockSource().
+struct CameraBlock {
+  mat4f view;
+  mat4f projection;
+  vec4f viewPosition;
+};
+static_assert(sizeof(CameraBlock) == 144,
+              "CameraBlock must match the std140 layout of the shader block");
+
+// GLSL declaration of the block. Its members are visible to the shader as
+// plain view, projection and viewPosition.
+std::string cameraBlockSource();
+
+// Uploads the camera if it differs from what the buffer already holds. The
+// buffer is created on first use in the current GL context.
+void updateCameraBlock(mat4f const &view, mat4f const &projection,
+                       vec3f const &viewPosition);
+
+template <typename ViewContextT>
+void updateCameraBlock(ViewContextT const &viewCtx) {
+  updateCameraBlock(viewCtx.camera.viewMatrix(),
+                    viewCtx.projection.projectionMatrix(),
+                    viewCtx.camera.viewPosition());
+}
+
+} // end namespace givr
+//------------------------------------------------------------------------------
+// END camera_block.h
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// Start stats.h
+//------------------------------------------------------------------------------
+
+#include <cstdint>
+
+//------------------------------------------------------------------------------
+// Per-frame render statistics. The counters (draws, vertices, instances and
+// bytes uploaded) are always kept. GPU time for draws and uploads is measured
+// with GL_TIME_ELAPSED queries when enabled; the queries of a frame are read
+// QUERY_FRAMES frames later, once the GPU has finished with them, so reading
+// them never stalls the pipeline.
+//
+// Call beginFrame() and endFrame() around each frame's rendering.
+//------------------------------------------------------------------------------
+namespace givr {
+namespace stats {
+
+constexpr std::size_t QUERY_FRAMES = 3;
+constexpr std::size_t HISTORY_LENGTH = 240;
+
+struct FrameStats {
+  std::uint64_t frame = 0;
+  std::uint32_t draws = 0;
+  std::uint64_t vertices = 0;
+  std::uint64_t instances = 0;
+  std::uint32_t uploads = 0;
+  std::uint64_t bytesUploaded = 0;
+
+  // GPU milliseconds, valid once the frame's queries have been read.
+  bool gpuTimeValid = false;
+  double gpuDrawMs = 0.0;
+  double gpuUploadMs = 0.0;
+};
+
+void setGpuTimingEnabled(bool enabled);
+bool gpuTimingEnabled();
+
+void beginFrame();
+void endFrame();
+
+// Counters of the frame being rendered.
+FrameStats const &current();
+// Completed frames, 0 being the most recent. The GPU times of the newest
+// QUERY_FRAMES frames are not yet known.
+FrameStats const &history(std::size_t framesAgo);
+std::size_t historySize();
+
+// Hooks for the renderers and buffers.
+void recordDraw(std::uint64_t vertices, std::uint64_t instances);
+void recordUpload(std::uint64_t bytes);
+
+enum class Timer { Draw, Upload };
+
+// Times the GL commands issued during its lifetime. GL_TIME_ELAPSED queries
+// cannot nest, so a timer started inside another one measures nothing.
+class ScopedGpuTimer {
+public:
+  explicit ScopedGpuTimer(Timer timer);
+  ~ScopedGpuTimer();
+
+  ScopedGpuTimer(const ScopedGpuTimer &) = delete;
+  ScopedGpuTimer &operator=(const ScopedGpuTimer &) = delete;
+
+private:
+  bool m_active;
+};
+
+} // end namespace stats
+} // end namespace givr
+//------------------------------------------------------------------------------
+// END stats.h
+//------------------------------------------------------------------------------
+
 //------------------------------------------------------------------------------
 // Start parameters.h
 //------------------------------------------------------------------------------
@@ -11827,6 +11958,7 @@ using PhongExponent = utility::Type<float, struct PhongExponent_Tag>;
 using SpecularFactor = utility::Type<float, struct SpecularFactor_Tag>;
 using Width = utility::Type<float, struct Width_Tag>;
 using GenerateNormals = utility::Type<bool, struct GenerateNormals_Tag>;
+using PointRadius = utility::Type<float, struct PointRadius_Tag>;
 using ColorTexture = utility::Type<Texture, struct ColorTexture_Tag>;
 
 } // end namespace style
@@ -11899,14 +12031,30 @@ struct Geometry : public utility::TypedStruct<Types...> {};
 // Start program.h
 //------------------------------------------------------------------------------
 
+#include <cstring>
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace givr {
 
+// A uniform location resolved once, typed by the value it takes. A location
+// of -1 (a uniform the linker optimized away) is silently ignored by GL.
+// Each style resolves its handles when a render context gets its program, so
+// draws set uniforms without looking their names up.
+template <typename T> struct UniformHandle {
+  GLint location = -1;
+  explicit operator bool() const { return location != -1; }
+};
+
 class Program {
 public:
   Program(GLuint vertex, GLuint fragment);
   Program(GLuint vertex, GLuint geometry, GLuint fragment);
+  // Takes ownership of a program that is already linked, e.g. one loaded
+  // with glProgramBinary.
+  explicit Program(GLuint program);
   ~Program();
 
   // Default ctor/dtor & move operations
@@ -11920,32 +12068,104 @@ public:
   operator GLuint() const { return m_programID; }
   void use();
 
-  void setVec2(const std::string &name, vec2f const &value) const;
-  void setVec3(const std::string &name, vec3f const &value) const;
-  void setMat4(const std::string &name, mat4f const &mat) const;
-  void setBool(const std::string &name, bool value) const;
-  void setFloat(const std::string &name, float value) const;
-  void setInt(const std::string &name, int value) const;
+  // Looks the name up in the locations resolved at link time, without
+  // touching GL or allocating.
+  GLint uniformLocation(const char *name) const;
+  template <typename T> UniformHandle<T> uniform(const char *name) const {
+    return UniformHandle<T>{uniformLocation(name)};
+  }
+
+  void set(UniformHandle<vec2f> handle, vec2f const &value) const;
+  void set(UniformHandle<vec3f> handle, vec3f const &value) const;
+  void set(UniformHandle<vec4f> handle, vec4f const &value) const;
+  void set(UniformHandle<mat4f> handle, mat4f const &mat) const;
+  void set(UniformHandle<bool> handle, bool value) const;
+  void set(UniformHandle<float> handle, float value) const;
+  void set(UniformHandle<int> handle, int value) const;
+
+  void setVec2(const char *name, vec2f const &value) const;
+  void setVec3(const char *name, vec3f const &value) const;
+  void setVec4(const char *name, vec4f const &value) const;
+  void setMat4(const char *name, mat4f const &mat) const;
+  void setBool(const char *name, bool value) const;
+  void setFloat(const char *name, float value) const;
+  void setInt(const char *name, int value) const;
+
+  void setVec2(const std::string &name, vec2f const &value) const {
+    setVec2(name.c_str(), value);
+  }
+  void setVec3(const std::string &name, vec3f const &value) const {
+    setVec3(name.c_str(), value);
+  }
+  void setVec4(const std::string &name, vec4f const &value) const {
+    setVec4(name.c_str(), value);
+  }
+  void setMat4(const std::string &name, mat4f const &mat) const {
+    setMat4(name.c_str(), mat);
+  }
+  void setBool(const std::string &name, bool value) const {
+    setBool(name.c_str(), value);
+  }
+  void setFloat(const std::string &name, float value) const {
+    setFloat(name.c_str(), value);
+  }
+  void setInt(const std::string &name, int value) const {
+    setInt(name.c_str(), value);
+  }
 
   // TODO: make these work for our math library
   /*
-  void setInt(const std::string &name, int value) const;
-  void setVec2(const std::string &name, const glm::vec2 &value) const;
   void setVec2(const std::string &name, float x, float y) const;
-  void setVec4(const std::string &name, const glm::vec4 &value) const;
   void setVec4(const std::string &name, float x, float y, float z, float w);
   void setMat2(const std::string &name, const glm::mat2 &mat) const;
   void setMat3(const std::string &name, const glm::mat3 &mat) const;*/
 
 private:
   void linkAndErrorCheck();
+  void resolveUniforms();
+
   GLuint m_programID = 0;
+  // Sorted by name for lookup.
+  std::vector<std::pair<std::string, GLint>> m_uniformLocations;
 };
 }; // end namespace givr
 //------------------------------------------------------------------------------
 // END program.h
 //------------------------------------------------------------------------------
 
+//------------------------------------------------------------------------------
+// Start program_cache.h
+//------------------------------------------------------------------------------
+
+#include <memory>
+#include <string>
+
+//------------------------------------------------------------------------------
+// Programs are shared by every context whose generated shader sources are
+// identical, so each distinct program is compiled once per process. Where the
+// driver supports program binaries they are also kept on disk, keyed by a
+// hash of the sources and checked against the driver that wrote them, so
+// later runs skip compilation too.
+//------------------------------------------------------------------------------
+namespace givr {
+
+std::shared_ptr<Program> getProgram(std::string const &vertexSource,
+                                    std::string const &fragmentSource);
+std::shared_ptr<Program> getProgram(std::string const &vertexSource,
+                                    std::string const &geometrySource,
+                                    std::string const &fragmentSource);
+
+// Where program binaries are stored. Defaults to $GIVR_PROGRAM_CACHE, or a
+// givr directory in the user's cache directory. An empty directory disables
+// the disk cache.
+void setProgramCacheDirectory(std::string directory);
+std::string const &programCacheDirectory();
+
+} // end namespace givr
+//------------------------------------------------------------------------------
+// END program_cache.h
+//------------------------------------------------------------------------------
+
 //------------------------------------------------------------------------------
 // Start span
 //------------------------------------------------------------------------------
@@ -15631,23 +15851,82 @@ public:
   void dealloc();
   void bind(GLenum target);
   void unbind(GLenum target);
+  // Data that fits in the buffer's current storage is written in place with
+  // glBufferSubData; the storage is only (re)allocated when it grows or the
+  // usage changes, so streaming the same amount every frame reuses it.
   template <typename T>
   void data(GLenum target, const gsl::span<T> &data, GLenum usage) {
-    glBufferData(target, sizeof(T) * data.size(), data.data(), usage);
+    upload(target, sizeof(T) * data.size(), data.data(), usage);
   }
   template <typename T>
   void data(GLenum target, const std::vector<T> &data, GLenum usage) {
-    glBufferData(target, sizeof(T) * data.size(), data.data(), usage);
+    upload(target, sizeof(T) * data.size(), data.data(), usage);
   }
 
+  GLsizeiptr capacity() const { return m_capacity; }
+
 private:
+  void upload(GLenum target, GLsizeiptr size, const void *data, GLenum usage);
+
   GLuint m_bufferID = 0;
+  GLsizeiptr m_capacity = 0;
+  GLenum m_usage = 0;
 };
 }; // end namespace givr
 //------------------------------------------------------------------------------
 // END buffer.h
 //------------------------------------------------------------------------------
 
+//------------------------------------------------------------------------------
+// Start shared_vertex_buffer.h
+//------------------------------------------------------------------------------
+
+#include <vector>
+
+namespace givr {
+
+// Positions owned outside any render context, uploaded once per frame and
+// read by every context attached to it with shareVertices(). A model that
+// draws its particles, springs and surface from the same positions uploads
+// them once instead of once per renderable. The GL buffer is created when it
+// is first used, so an owner can be constructed off the GL thread.
+class SharedVertexBuffer {
+public:
+  SharedVertexBuffer() = default;
+
+  // No copies; contexts keep a pointer to this buffer.
+  SharedVertexBuffer(const SharedVertexBuffer &) = delete;
+  SharedVertexBuffer &operator=(const SharedVertexBuffer &) = delete;
+
+  void upload(gsl::span<const vec3f> positions) {
+    Buffer &vbo = buffer();
+    vbo.bind(GL_ARRAY_BUFFER);
+    vbo.data(GL_ARRAY_BUFFER, positions, GL_DYNAMIC_DRAW);
+    vbo.unbind(GL_ARRAY_BUFFER);
+    m_count = GLuint(positions.size());
+  }
+  void upload(std::vector<vec3f> const &positions) {
+    upload(gsl::span<const vec3f>(positions));
+  }
+
+  // Number of positions in the last upload.
+  GLuint size() const { return m_count; }
+  Buffer &buffer() {
+    if (!m_buffer) {
+      m_buffer = std::make_unique<Buffer>();
+    }
+    return *m_buffer;
+  }
+
+private:
+  std::unique_ptr<Buffer> m_buffer;
+  GLuint m_count = 0;
+};
+}; // end namespace givr
+//------------------------------------------------------------------------------
+// END shared_vertex_buffer.h
+//------------------------------------------------------------------------------
+
 //------------------------------------------------------------------------------
 // Start gsl_algorithm
 //------------------------------------------------------------------------------
@@ -16461,7 +16740,9 @@ bool operator>=(const T &one, gsl::basic_string_span<CharT, Extent> other) {
 namespace givr {
 
 template <typename GeometryT, typename StyleT> struct RenderContext {
-  std::unique_ptr<Program> shaderProgram;
+  std::shared_ptr<Program> shaderProgram;
+  // The style's uniforms in shaderProgram
+  typename StyleT::Uniforms uniforms;
   std::unique_ptr<VertexArray> vao;
 
   // Keep references to the GL_ARRAY_BUFFERS so that
@@ -16475,6 +16756,11 @@ template <typename GeometryT, typename StyleT> struct RenderContext {
   PrimitiveType primitive;
 
   bool hasIndices = false;
+  std::uint64_t indicesRevision = 0;
+
+  // Set by shareVertices(); the positions then come from this buffer and the
+  // geometry's own vertices are not uploaded.
+  SharedVertexBuffer *sharedVertices = nullptr;
 
   typename StyleT::Parameters params;
 
@@ -16488,35 +16774,51 @@ template <typename GeometryT, typename StyleT> struct RenderContext {
   RenderContext(const RenderContext &) = delete;
   RenderContext &operator=(const RenderContext &) = delete;
 
-  std::string getModelSource() const { return "uniform"; }
+  std::string getModelSource() const { return "uniform mat4 model;\n"; }
 };
 
-template <typename GeometryT, typename StyleT, typename ViewContextT>
-void drawArray(
-    RenderContext<GeometryT, StyleT> &ctx, ViewContextT const &viewCtx,
-    std::function<void(std::unique_ptr<Program> const &)> setUniforms) {
-  ctx.shaderProgram->use();
-
-  mat4f view = viewCtx.camera.viewMatrix();
-  mat4f projection = viewCtx.projection.projectionMatrix();
-  vec3f viewPosition = viewCtx.camera.viewPosition();
+// Geometry with fixed connectivity tags its indices with a revision so that
+// the index buffer is only re-uploaded when the connectivity changes.
+template <typename GeometryT, typename ContextT>
+bool indicesOutOfDate(ContextT &ctx, typename GeometryT::Data const &data) {
+  if constexpr (hasIndicesRevision<GeometryT>::value) {
+    if (ctx.indicesRevision == data.indicesRevision) {
+      return false;
+    }
+    ctx.indicesRevision = data.indicesRevision;
+  }
+  return true;
+}
 
-  ctx.shaderProgram->setVec3("viewPosition", viewPosition);
-  ctx.shaderProgram->setMat4("view", view);
-  ctx.shaderProgram->setMat4("projection", projection);
+// setUniforms is any callable taking the context's program. It is a template
+// parameter rather than a std::function so that capturing lambdas never
+// allocate on the draw path.
+template <typename GeometryT, typename StyleT, typename ViewContextT,
+          typename SetUniformsT>
+void drawArray(RenderContext<GeometryT, StyleT> &ctx,
+               ViewContextT const &viewCtx, SetUniformsT &&setUniforms) {
+  ctx.shaderProgram->use();
+  updateCameraBlock(viewCtx);
   setUniforms(ctx.shaderProgram);
   ctx.vao->bind();
   glPolygonMode(GL_FRONT, GL_FILL);
   GLenum mode = givr::getMode(ctx.primitive);
-  if constexpr (hasIndices<GeometryT>::value) {
-    if (ctx.numberOfIndices > 0) {
-      glDrawElements(mode, ctx.numberOfIndices, GL_UNSIGNED_INT, 0);
+  GLuint vertexCount =
+      ctx.sharedVertices ? ctx.sharedVertices->size() : ctx.vertexCount;
+  {
+    stats::ScopedGpuTimer timer(stats::Timer::Draw);
+    if constexpr (hasIndices<GeometryT>::value) {
+      if (ctx.numberOfIndices > 0) {
+        glDrawElements(mode, ctx.numberOfIndices, GL_UNSIGNED_INT, 0);
+        vertexCount = ctx.numberOfIndices;
+      } else {
+        glDrawArrays(mode, ctx.startIndex, vertexCount);
+      }
     } else {
-      glDrawArrays(mode, ctx.startIndex, ctx.vertexCount);
+      glDrawArrays(mode, ctx.startIndex, vertexCount);
     }
-  } else {
-    glDrawArrays(mode, ctx.startIndex, ctx.vertexCount);
   }
+  stats::recordDraw(vertexCount, 1);
 
   ctx.vao->unbind();
 }
@@ -16551,6 +16853,9 @@ void allocateBuffers(RenderContext<GeometryT, StyleT> &ctx) {
   if constexpr (hasColours<GeometryT>::value) {
     allocateBuffer(); // data.colours);
   }
+  if constexpr (hasRadii<GeometryT>::value) {
+    allocateBuffer(); // data.radii);
+  }
 }
 template <typename GeometryT, typename StyleT>
 void uploadBuffers(RenderContext<GeometryT, StyleT> &ctx,
@@ -16564,54 +16869,65 @@ void uploadBuffers(RenderContext<GeometryT, StyleT> &ctx,
   ctx.startIndex = 0;
   ctx.vertexCount = data.vertices.size() / data.dimensions;
 
-  std::uint16_t vaIndex = 4;
   ctx.vao->bind();
 
   std::uint16_t bufferIndex = 0;
   if constexpr (hasIndices<GeometryT>::value) {
     std::unique_ptr<Buffer> &indices = ctx.arrayBuffers[0];
     indices->bind(GL_ELEMENT_ARRAY_BUFFER);
-    indices->data(GL_ELEMENT_ARRAY_BUFFER, data.indices,
-                  getBufferUsageType(data.indicesType));
+    if (indicesOutOfDate<GeometryT>(ctx, data)) {
+      indices->data(GL_ELEMENT_ARRAY_BUFFER, data.indices,
+                    getBufferUsageType(data.indicesType));
+    }
     ++bufferIndex;
   }
 
-  auto applyBuffer = [&ctx, &vaIndex, &bufferIndex](
-                         GLenum type, GLuint size, GLenum bufferType,
-                         std::string name, gsl::span<const float> const &data) {
+  // Each attribute has a fixed location that the shaders declare, whether or
+  // not the attributes before it are present.
+  auto applyBuffer = [&ctx, &bufferIndex](GLuint vaIndex, GLenum type,
+                                          GLuint size, GLenum bufferType,
+                                          const char *name,
+                                          gsl::span<const float> const &data) {
     // if this data piece is empty disable this one.
     std::unique_ptr<Buffer> &vbo = ctx.arrayBuffers[bufferIndex];
     vbo->bind(type);
     if (data.size() == 0) {
       glDisableVertexAttribArray(vaIndex);
     } else {
-      glBindAttribLocation(*ctx.shaderProgram.get(), vaIndex, name.c_str());
+      glBindAttribLocation(*ctx.shaderProgram.get(), vaIndex, name);
       vbo->data(type, data, bufferType);
       glVertexAttribPointer(vaIndex, size, GL_FLOAT, GL_FALSE, 0, (GLvoid *)0);
       glEnableVertexAttribArray(vaIndex);
     }
-    ++vaIndex;
     ++bufferIndex;
   };
 
   // Upload / bind / map model data
   if constexpr (hasVertices<GeometryT>::value) {
-    applyBuffer(GL_ARRAY_BUFFER, data.dimensions,
-                getBufferUsageType(data.verticesType), "position",
-                data.vertices);
+    if (ctx.sharedVertices) {
+      ++bufferIndex;
+    } else {
+      applyBuffer(4, GL_ARRAY_BUFFER, data.dimensions,
+                  getBufferUsageType(data.verticesType), "position",
+                  data.vertices);
+    }
   }
   if constexpr (hasNormals<GeometryT>::value) {
-    applyBuffer(GL_ARRAY_BUFFER, data.dimensions,
+    applyBuffer(5, GL_ARRAY_BUFFER, data.dimensions,
                 getBufferUsageType(data.normalsType), "normals", data.normals);
   }
   if constexpr (hasUvs<GeometryT>::value) {
-    applyBuffer(GL_ARRAY_BUFFER, 2, getBufferUsageType(data.uvsType), "uvs",
+    applyBuffer(6, GL_ARRAY_BUFFER, 2, getBufferUsageType(data.uvsType), "uvs",
                 data.uvs);
   }
   if constexpr (hasColours<GeometryT>::value) {
-    applyBuffer(GL_ARRAY_BUFFER, 3, getBufferUsageType(data.coloursType),
+    applyBuffer(7, GL_ARRAY_BUFFER, 3, getBufferUsageType(data.coloursType),
                 "colour", data.colours);
   }
+  if constexpr (hasRadii<GeometryT>::value) {
+    applyBuffer(8, GL_ARRAY_BUFFER, 1, getBufferUsageType(data.radiiType),
+                "radius", data.radii);
+  }
 
   ctx.vao->unbind();
 
@@ -16622,11 +16938,92 @@ void uploadBuffers(RenderContext<GeometryT, StyleT> &ctx,
     }
   }
 }
+
+// Points the context's positions at a shared buffer. The buffer must outlive
+// the context; whatever was last uploaded to it is drawn, so contexts whose
+// other data does not change need no updateRenderable() per frame.
+template <typename GeometryT, typename StyleT>
+void shareVertices(RenderContext<GeometryT, StyleT> &ctx,
+                   SharedVertexBuffer &shared) {
+  static_assert(hasVertices<GeometryT>::value,
+                "Only geometry with vertices can share a vertex buffer.");
+  ctx.sharedVertices = &shared;
+  ctx.vao->bind();
+  shared.buffer().bind(GL_ARRAY_BUFFER);
+  glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, 0, (GLvoid *)0);
+  glEnableVertexAttribArray(4);
+  ctx.vao->unbind();
+  shared.buffer().unbind(GL_ARRAY_BUFFER);
+}
 }; // end namespace givr
 //------------------------------------------------------------------------------
 // END renderer.h
 //------------------------------------------------------------------------------
 
+//------------------------------------------------------------------------------
+// Start instance_layout.h
+//------------------------------------------------------------------------------
+
+#include <array>
+#include <cstddef>
+#include <string>
+
+#include <glm/gtc/quaternion.hpp>
+
+//------------------------------------------------------------------------------
+// Per-instance data layouts for InstancedRenderContext. Each layout describes
+// the value stored per instance, how it is laid out in the instance buffer
+// (attribute locations 0-3 are reserved for it) and the GLSL that rebuilds
+// the `model` matrix from it in the vertex shader. Smaller layouts mean less
+// data uploaded every frame.
+//------------------------------------------------------------------------------
+namespace givr {
+namespace instancing {
+
+struct Attribute {
+  GLint components;
+  std::size_t offset;
+};
+
+// A full model matrix per instance (64 bytes).
+struct Transform {
+  using Value = mat4f;
+  static constexpr std::array<Attribute, 4> attributes{
+      {{4, 0}, {4, sizeof(vec4f)}, {4, 2 * sizeof(vec4f)}, {4, 3 * sizeof(vec4f)}}};
+  static std::string modelSource();
+};
+
+// A translation per instance (12 bytes).
+struct Offset {
+  using Value = vec3f;
+  static constexpr std::array<Attribute, 1> attributes{{{3, 0}}};
+  static std::string modelSource();
+};
+
+// A translation in xyz and a uniform scale in w (16 bytes).
+struct OffsetScale {
+  using Value = vec4f;
+  static constexpr std::array<Attribute, 1> attributes{{{4, 0}}};
+  static std::string modelSource();
+};
+
+// A translation and a unit quaternion rotation (28 bytes).
+struct OffsetRotation {
+  struct Value {
+    vec3f offset;
+    glm::quat rotation;
+  };
+  static constexpr std::array<Attribute, 2> attributes{
+      {{3, offsetof(Value, offset)}, {4, offsetof(Value, rotation)}}};
+  static std::string modelSource();
+};
+
+} // end namespace instancing
+} // end namespace givr
+//------------------------------------------------------------------------------
+// END instance_layout.h
+//------------------------------------------------------------------------------
+
 //------------------------------------------------------------------------------
 // Start instanced_renderer.h
 //------------------------------------------------------------------------------
@@ -16637,12 +17034,18 @@ void uploadBuffers(RenderContext<GeometryT, StyleT> &ctx,
 
 namespace givr {
 
-template <typename GeometryT, typename StyleT> struct InstancedRenderContext {
-  std::unique_ptr<Program> shaderProgram;
+template <typename GeometryT, typename StyleT,
+          typename InstanceT = instancing::Transform>
+struct InstancedRenderContext {
+  using Instance = InstanceT;
+
+  std::shared_ptr<Program> shaderProgram;
+  // The style's uniforms in shaderProgram
+  typename StyleT::Uniforms uniforms;
   std::unique_ptr<VertexArray> vao;
 
-  std::vector<mat4f> modelTransforms;
-  std::unique_ptr<Buffer> modelTransformsBuffer;
+  std::vector<typename InstanceT::Value> instances;
+  std::unique_ptr<Buffer> instancesBuffer;
 
   // Keep references to the GL_ARRAY_BUFFERS so that
   // the stay in scope for this context.
@@ -16654,6 +17057,8 @@ template <typename GeometryT, typename StyleT> struct InstancedRenderContext {
 
   PrimitiveType primitive;
 
+  std::uint64_t indicesRevision = 0;
+
   typename StyleT::Parameters params;
 
   // Default ctor/dtor & move operations
@@ -16666,57 +17071,58 @@ template <typename GeometryT, typename StyleT> struct InstancedRenderContext {
   InstancedRenderContext(const InstancedRenderContext &) = delete;
   InstancedRenderContext &operator=(const InstancedRenderContext &) = delete;
 
-  std::string getModelSource() { return "layout(location=0) in "; }
+  std::string getModelSource() { return InstanceT::modelSource(); }
 };
 
-template <typename GeometryT, typename StyleT, typename ViewContextT>
-void drawInstanced(
-    InstancedRenderContext<GeometryT, StyleT> &ctx, ViewContextT const &viewCtx,
-    std::function<void(std::unique_ptr<Program> const &)> setUniforms) {
+template <typename GeometryT, typename StyleT, typename InstanceT,
+          typename ViewContextT, typename SetUniformsT>
+void drawInstanced(InstancedRenderContext<GeometryT, StyleT, InstanceT> &ctx,
+                   ViewContextT const &viewCtx, SetUniformsT &&setUniforms) {
   ctx.shaderProgram->use();
-
-  mat4f view = viewCtx.camera.viewMatrix();
-  mat4f projection = viewCtx.projection.projectionMatrix();
-  vec3f viewPosition = viewCtx.camera.viewPosition();
-
-  ctx.shaderProgram->setVec3("viewPosition", viewPosition);
-  ctx.shaderProgram->setMat4("view", view);
-  ctx.shaderProgram->setMat4("projection", projection);
+  updateCameraBlock(viewCtx);
   setUniforms(ctx.shaderProgram);
 
   ctx.vao->bind();
   glPolygonMode(GL_FRONT, GL_FILL);
   GLenum mode = givr::getMode(ctx.primitive);
-  ctx.modelTransformsBuffer->bind(GL_ARRAY_BUFFER);
-  ctx.modelTransformsBuffer->data(
-      GL_ARRAY_BUFFER, gsl::span<mat4f>(ctx.modelTransforms), GL_DYNAMIC_DRAW);
+  ctx.instancesBuffer->bind(GL_ARRAY_BUFFER);
+  ctx.instancesBuffer->data(
+      GL_ARRAY_BUFFER,
+      gsl::span<typename InstanceT::Value>(ctx.instances), GL_DYNAMIC_DRAW);
 
-  if constexpr (hasIndices<GeometryT>::value) {
-    if (ctx.numberOfIndices > 0) {
-      glDrawElementsInstanced(mode, ctx.numberOfIndices, GL_UNSIGNED_INT, 0,
-                              ctx.modelTransforms.size());
+  GLuint vertexCount = ctx.vertexCount;
+  {
+    stats::ScopedGpuTimer timer(stats::Timer::Draw);
+    if constexpr (hasIndices<GeometryT>::value) {
+      if (ctx.numberOfIndices > 0) {
+        glDrawElementsInstanced(mode, ctx.numberOfIndices, GL_UNSIGNED_INT, 0,
+                                ctx.instances.size());
+        vertexCount = ctx.numberOfIndices;
+      } else {
+        glDrawArraysInstanced(mode, ctx.startIndex, ctx.vertexCount,
+                              ctx.instances.size());
+      }
     } else {
       glDrawArraysInstanced(mode, ctx.startIndex, ctx.vertexCount,
-                            ctx.modelTransforms.size());
+                            ctx.instances.size());
     }
-  } else {
-    glDrawArraysInstanced(mode, ctx.startIndex, ctx.vertexCount,
-                          ctx.modelTransforms.size());
   }
+  stats::recordDraw(std::uint64_t(vertexCount) * ctx.instances.size(),
+                    ctx.instances.size());
 
   ctx.vao->unbind();
 
-  ctx.modelTransforms.clear();
+  ctx.instances.clear();
 }
 
-template <typename GeometryT, typename StyleT>
-void allocateBuffers(InstancedRenderContext<GeometryT, StyleT> &ctx) {
+template <typename GeometryT, typename StyleT, typename InstanceT>
+void allocateBuffers(InstancedRenderContext<GeometryT, StyleT, InstanceT> &ctx) {
   ctx.vao = std::make_unique<VertexArray>();
   ctx.vao->alloc();
 
-  // Map - but don't upload framing data.
-  ctx.modelTransformsBuffer = std::make_unique<Buffer>();
-  ctx.modelTransformsBuffer->alloc();
+  // Map - but don't upload instance data.
+  ctx.instancesBuffer = std::make_unique<Buffer>();
+  ctx.instancesBuffer->alloc();
 
   if constexpr (hasIndices<GeometryT>::value) {
     // Map - but don't upload indices data
@@ -16746,8 +17152,8 @@ void allocateBuffers(InstancedRenderContext<GeometryT, StyleT> &ctx) {
   }
 }
 
-template <typename GeometryT, typename StyleT>
-void uploadBuffers(InstancedRenderContext<GeometryT, StyleT> &ctx,
+template <typename GeometryT, typename StyleT, typename InstanceT>
+void uploadBuffers(InstancedRenderContext<GeometryT, StyleT, InstanceT> &ctx,
                    typename GeometryT::Data const &data) {
   // Start by setting the appropriate context variables for rendering.
   if constexpr (hasIndices<GeometryT>::value) {
@@ -16758,59 +17164,63 @@ void uploadBuffers(InstancedRenderContext<GeometryT, StyleT> &ctx,
   ctx.startIndex = 0;
   ctx.vertexCount = data.vertices.size() / data.dimensions;
 
-  std::uint16_t vaIndex = 0;
   ctx.vao->bind();
 
-  // Upload framing data.
-  ctx.modelTransformsBuffer->bind(GL_ARRAY_BUFFER);
-  auto vec4Size = sizeof(mat4f) / 4;
-  for (std::uint16_t i = 0; i < 4; ++i) {
-    glVertexAttribPointer(vaIndex, 4, GL_FLOAT, GL_FALSE, sizeof(mat4f),
-                          (GLvoid *)(i * vec4Size));
-    glEnableVertexAttribArray(vaIndex);
-    glVertexAttribDivisor(vaIndex, 1);
-    ++vaIndex;
+  // Describe the instance data, one attribute per location from 0.
+  ctx.instancesBuffer->bind(GL_ARRAY_BUFFER);
+  GLuint instanceIndex = 0;
+  for (instancing::Attribute const &attribute : InstanceT::attributes) {
+    glVertexAttribPointer(instanceIndex, attribute.components, GL_FLOAT,
+                          GL_FALSE, sizeof(typename InstanceT::Value),
+                          (GLvoid *)attribute.offset);
+    glEnableVertexAttribArray(instanceIndex);
+    glVertexAttribDivisor(instanceIndex, 1);
+    ++instanceIndex;
   }
 
   std::uint16_t bufferIndex = 0;
   if constexpr (hasIndices<GeometryT>::value) {
     std::unique_ptr<Buffer> &indices = ctx.arrayBuffers[0];
     indices->bind(GL_ELEMENT_ARRAY_BUFFER);
-    indices->data(GL_ELEMENT_ARRAY_BUFFER, data.indices,
-                  getBufferUsageType(data.indicesType));
+    if (indicesOutOfDate<GeometryT>(ctx, data)) {
+      indices->data(GL_ELEMENT_ARRAY_BUFFER, data.indices,
+                    getBufferUsageType(data.indicesType));
+    }
     ++bufferIndex;
   }
 
-  auto applyBuffer = [&ctx, &vaIndex, &bufferIndex](
-                         GLenum type, GLuint size, GLenum bufferType,
-                         std::string name, gsl::span<const float> const &data) {
+  // The geometry attributes keep their fixed locations from 4 up, however
+  // many locations the instance layout uses.
+  auto applyBuffer = [&ctx, &bufferIndex](GLuint vaIndex, GLenum type,
+                                          GLuint size, GLenum bufferType,
+                                          const char *name,
+                                          gsl::span<const float> const &data) {
     std::unique_ptr<Buffer> &vbo = ctx.arrayBuffers[bufferIndex];
     vbo->bind(type);
     if (data.size() == 0) {
       glDisableVertexAttribArray(vaIndex);
     } else {
       vbo->data(type, data, bufferType);
-      glBindAttribLocation(*ctx.shaderProgram.get(), vaIndex, name.c_str());
+      glBindAttribLocation(*ctx.shaderProgram.get(), vaIndex, name);
       glVertexAttribPointer(vaIndex, size, GL_FLOAT, GL_FALSE, 0, (GLvoid *)0);
       glEnableVertexAttribArray(vaIndex);
     }
-    ++vaIndex;
     ++bufferIndex;
   };
 
   // Upload / bind / map model data
   if constexpr (hasVertices<GeometryT>::value)
-    applyBuffer(GL_ARRAY_BUFFER, data.dimensions,
+    applyBuffer(4, GL_ARRAY_BUFFER, data.dimensions,
                 getBufferUsageType(data.verticesType), "position",
                 data.vertices);
   if constexpr (hasNormals<GeometryT>::value)
-    applyBuffer(GL_ARRAY_BUFFER, data.dimensions,
+    applyBuffer(5, GL_ARRAY_BUFFER, data.dimensions,
                 getBufferUsageType(data.normalsType), "normals", data.normals);
   if constexpr (hasUvs<GeometryT>::value)
-    applyBuffer(GL_ARRAY_BUFFER, 2, getBufferUsageType(data.uvsType), "uvs",
+    applyBuffer(6, GL_ARRAY_BUFFER, 2, getBufferUsageType(data.uvsType), "uvs",
                 data.uvs);
   if constexpr (hasColours<GeometryT>::value)
-    applyBuffer(GL_ARRAY_BUFFER, 3, getBufferUsageType(data.coloursType),
+    applyBuffer(7, GL_ARRAY_BUFFER, 3, getBufferUsageType(data.coloursType),
                 "colour", data.colours);
 
   ctx.vao->unbind();
@@ -16912,6 +17322,312 @@ MultiLine::Data generateGeometry(MultiLine const &l);
 // END multiline.h
 //------------------------------------------------------------------------------
 
+//------------------------------------------------------------------------------
+// Start line_segments.h
+//------------------------------------------------------------------------------
+#include <cstddef>
+#include <vector>
+
+namespace givr {
+namespace geometry {
+
+// Independent line segments streamed every frame. The end points are written
+// straight into a vector that keeps its capacity across clear(), and the
+// generated Data only views it, so rebuilding the same number of segments
+// each frame does not allocate.
+struct LineSegments {
+private:
+  std::vector<vec3f> m_vertices;
+
+public:
+  LineSegments() = default;
+
+  void clear() { m_vertices.clear(); }
+  void reserve(std::size_t segments) { m_vertices.reserve(2 * segments); }
+  std::size_t size() const { return m_vertices.size() / 2; }
+
+  void push_back(vec3f const &p1, vec3f const &p2) {
+    m_vertices.push_back(p1);
+    m_vertices.push_back(p2);
+  }
+
+  // Two vertices per segment, for writing in place.
+  std::vector<vec3f> &vertices() { return m_vertices; }
+  std::vector<vec3f> const &vertices() const { return m_vertices; }
+
+  struct Data : public VertexArrayData<PrimitiveType::LINES> {
+    std::uint16_t dimensions = 3;
+
+    BufferUsageType verticesType = BufferUsageType::DYNAMIC_DRAW;
+    gsl::span<const float> vertices;
+  };
+};
+
+LineSegments::Data generateGeometry(LineSegments const &l);
+} // end namespace geometry
+} // end namespace givr
+//------------------------------------------------------------------------------
+// END line_segments.h
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// Start spring_network.h
+//------------------------------------------------------------------------------
+#include <cstdint>
+#include <vector>
+
+namespace givr {
+namespace geometry {
+
+// Lines between pairs of particles, drawn indexed. The pairs are set once and
+// only uploaded again when they change, so each frame streams one position
+// per particle rather than both end points of every line.
+struct SpringNetwork {
+private:
+  std::vector<vec3f> m_vertices;
+  std::vector<std::uint32_t> m_indices;
+  std::uint64_t m_indicesRevision = 0;
+
+public:
+  SpringNetwork() = default;
+
+  std::vector<vec3f> &vertices() { return m_vertices; }
+  std::vector<vec3f> const &vertices() const { return m_vertices; }
+  std::vector<std::uint32_t> const &indices() const { return m_indices; }
+  std::uint64_t indicesRevision() const { return m_indicesRevision; }
+
+  // Two vertex indices per line.
+  void setIndices(std::vector<std::uint32_t> indices);
+
+  struct Data : public VertexArrayData<PrimitiveType::LINES> {
+    std::uint16_t dimensions = 3;
+
+    BufferUsageType verticesType = BufferUsageType::DYNAMIC_DRAW;
+    BufferUsageType indicesType = BufferUsageType::STATIC_DRAW;
+
+    std::uint64_t indicesRevision = 0;
+
+    gsl::span<const float> vertices;
+    gsl::span<const std::uint32_t> indices;
+  };
+};
+
+SpringNetwork::Data generateGeometry(SpringNetwork const &n);
+} // end namespace geometry
+} // end namespace givr
+//------------------------------------------------------------------------------
+// END spring_network.h
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// Start parallel.h
+//------------------------------------------------------------------------------
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace givr {
+
+// A pool of persistent worker threads for splitting large per-vertex and
+// per-triangle loops across cores. The calling thread takes part in the work
+// and parallelFor blocks until every chunk is done. Dispatching does not
+// allocate, so it is safe to use from per-frame code.
+// Only one thread may dispatch work at a time.
+class WorkerPool {
+public:
+  explicit WorkerPool(std::size_t workers);
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool &) = delete;
+  WorkerPool &operator=(const WorkerPool &) = delete;
+
+  // Shared pool sized to the hardware
+  static WorkerPool &instance();
+
+  // Number of threads that take part in a parallelFor, including the caller
+  std::size_t concurrency() const { return m_workers.size() + 1; }
+
+  // Calls body(begin, end) over [0, count) in chunks of at most grain items.
+  template <typename Body>
+  void parallelFor(std::size_t count, std::size_t grain, Body const &body) {
+    grain = std::max<std::size_t>(grain, 1);
+    if (count <= grain || m_workers.empty()) {
+      body(std::size_t(0), count);
+      return;
+    }
+    run(count, grain, &invoke<Body>, &body);
+  }
+
+private:
+  using Task = void (*)(void const *, std::size_t, std::size_t);
+
+  template <typename Body>
+  static void invoke(void const *body, std::size_t begin, std::size_t end) {
+    (*static_cast<Body const *>(body))(begin, end);
+  }
+
+  void run(std::size_t count, std::size_t grain, Task task, void const *body);
+  void work();
+  void workerLoop();
+
+  std::vector<std::thread> m_workers;
+  std::mutex m_mutex;
+  std::condition_variable m_wake;
+  std::condition_variable m_done;
+
+  Task m_task = nullptr;
+  void const *m_body = nullptr;
+  std::size_t m_count = 0;
+  std::size_t m_grain = 0;
+  std::atomic<std::size_t> m_next{0};
+  std::size_t m_busy = 0;
+  std::uint64_t m_generation = 0;
+  bool m_stop = false;
+};
+
+template <typename Body>
+void parallelFor(std::size_t count, std::size_t grain, Body const &body) {
+  WorkerPool::instance().parallelFor(count, grain, body);
+}
+} // end namespace givr
+//------------------------------------------------------------------------------
+// END parallel.h
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// Start surface_mesh.h
+//------------------------------------------------------------------------------
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace givr {
+namespace geometry {
+
+// An indexed triangle mesh for deforming surfaces. The connectivity is set
+// once and only uploaded again when it changes, while the vertex positions
+// (and optionally normals) are streamed every frame. Each vertex is stored
+// once, so the normals are smooth across shared edges.
+struct SurfaceMesh {
+private:
+  std::vector<vec3f> m_vertices;
+  std::vector<vec3f> m_normals;
+  std::vector<std::uint32_t> m_indices;
+  std::uint64_t m_indicesRevision = 0;
+
+  // Scratch space for the normal pass. The triangles around each vertex are
+  // stored compressed (CSR) so that every vertex gathers its own normal and
+  // the pass can run in parallel without atomics.
+  std::vector<vec3f> m_faceNormals;
+  std::vector<std::uint32_t> m_vertexTriangleOffsets;
+  std::vector<std::uint32_t> m_vertexTriangles;
+
+  void buildVertexTriangles(std::size_t vertexCount);
+
+public:
+  SurfaceMesh() = default;
+
+  std::vector<vec3f> &vertices() { return m_vertices; }
+  std::vector<vec3f> const &vertices() const { return m_vertices; }
+  std::vector<vec3f> &normals() { return m_normals; }
+  std::vector<vec3f> const &normals() const { return m_normals; }
+  std::vector<std::uint32_t> const &indices() const { return m_indices; }
+  std::uint64_t indicesRevision() const { return m_indicesRevision; }
+
+  // Three indices per triangle, counter-clockwise when seen from outside.
+  void setIndices(std::vector<std::uint32_t> indices);
+
+  // Area weighted vertex normals from the current vertex positions. Large
+  // meshes are split across the shared WorkerPool.
+  void computeNormals();
+
+  struct Data : public VertexArrayData<PrimitiveType::TRIANGLES> {
+    std::uint16_t dimensions = 3;
+
+    BufferUsageType verticesType = BufferUsageType::DYNAMIC_DRAW;
+    BufferUsageType normalsType = BufferUsageType::DYNAMIC_DRAW;
+    BufferUsageType indicesType = BufferUsageType::STATIC_DRAW;
+
+    std::uint64_t indicesRevision = 0;
+
+    gsl::span<const float> vertices;
+    gsl::span<const float> normals;
+    gsl::span<const std::uint32_t> indices;
+  };
+};
+
+SurfaceMesh::Data generateGeometry(SurfaceMesh const &m);
+} // end namespace geometry
+} // end namespace givr
+//------------------------------------------------------------------------------
+// END surface_mesh.h
+//------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// Start point_cloud.h
+//------------------------------------------------------------------------------
+#include <vector>
+
+namespace givr {
+namespace geometry {
+
+// A stream of points, one per particle, drawn by point based styles such as
+// SphereImpostor. The radii and colours are optional; when they are left
+// empty the style's uniform values are used instead. Indices are optional
+// too, for drawing a fixed subset of the points (e.g. of a shared vertex
+// buffer).
+struct PointCloud {
+private:
+  std::vector<vec3f> m_vertices;
+  std::vector<float> m_radii;
+  std::vector<vec3f> m_colours;
+  std::vector<std::uint32_t> m_indices;
+  std::uint64_t m_indicesRevision = 0;
+
+public:
+  PointCloud() = default;
+
+  std::vector<vec3f> &vertices() { return m_vertices; }
+  std::vector<vec3f> const &vertices() const { return m_vertices; }
+  std::vector<float> &radii() { return m_radii; }
+  std::vector<float> const &radii() const { return m_radii; }
+  std::vector<vec3f> &colours() { return m_colours; }
+  std::vector<vec3f> const &colours() const { return m_colours; }
+  std::vector<std::uint32_t> const &indices() const { return m_indices; }
+  std::uint64_t indicesRevision() const { return m_indicesRevision; }
+
+  // Draws only the listed points; empty draws them all.
+  void setIndices(std::vector<std::uint32_t> indices);
+
+  struct Data : public VertexArrayData<PrimitiveType::POINTS> {
+    std::uint16_t dimensions = 3;
+
+    BufferUsageType verticesType = BufferUsageType::DYNAMIC_DRAW;
+    BufferUsageType radiiType = BufferUsageType::DYNAMIC_DRAW;
+    BufferUsageType coloursType = BufferUsageType::DYNAMIC_DRAW;
+    BufferUsageType indicesType = BufferUsageType::STATIC_DRAW;
+
+    std::uint64_t indicesRevision = 0;
+
+    gsl::span<const float> vertices;
+    gsl::span<const float> radii;
+    gsl::span<const float> colours;
+    gsl::span<const std::uint32_t> indices;
+  };
+};
+
+PointCloud::Data generateGeometry(PointCloud const &p);
+} // end namespace geometry
+} // end namespace givr
+//------------------------------------------------------------------------------
+// END point_cloud.h
+//------------------------------------------------------------------------------
+
 //------------------------------------------------------------------------------
 // Start gsl
 //------------------------------------------------------------------------------
@@ -16951,13 +17667,17 @@ MultiLine::Data generateGeometry(MultiLine const &l);
 // for (..) {
 //     addInstance(spheres, at(x, y));
 // }
+// or with a smaller per-instance layout:
+// auto spheres = createInstancedRenderable<instancing::Offset>(geom, style);
+// addInstance(spheres, vec3f(x, y, z));
 // draw(spheres, view);
 //------------------------------------------------------------------------------
 namespace givr {
-template <typename GeometryT, typename StyleT>
-InstancedRenderContext<GeometryT, StyleT>
+template <typename InstanceT = instancing::Transform, typename GeometryT,
+          typename StyleT>
+InstancedRenderContext<GeometryT, StyleT, InstanceT>
 createInstancedRenderable(GeometryT const &g, StyleT const &style) {
-  auto ctx = getInstancedContext(g, style);
+  auto ctx = getInstancedContext(g, style, InstanceT{});
   allocateBuffers(ctx);
   uploadBuffers(ctx, fillBuffers(g, style));
   return ctx;
@@ -16970,9 +17690,9 @@ RenderContext<GeometryT, StyleT> createRenderable(GeometryT const &g,
   uploadBuffers(ctx, fillBuffers(g, style));
   return ctx;
 }
-template <typename GeometryT, typename StyleT>
+template <typename GeometryT, typename StyleT, typename InstanceT>
 void updateRenderable(GeometryT const &g, StyleT const &style,
-                      InstancedRenderContext<GeometryT, StyleT> &ctx) {
+                      InstancedRenderContext<GeometryT, StyleT, InstanceT> &ctx) {
   updateStyle(ctx, style);
   uploadBuffers(ctx, fillBuffers(g, style));
 }
@@ -16982,10 +17702,10 @@ void updateRenderable(GeometryT const &g, StyleT const &style,
   updateStyle(ctx, style);
   uploadBuffers(ctx, fillBuffers(g, style));
 }
-template <typename GeometryT, typename StyleT>
-void addInstance(InstancedRenderContext<GeometryT, StyleT> &ctx,
-                 glm::mat4 const &f) {
-  ctx.modelTransforms.push_back(f);
+template <typename GeometryT, typename StyleT, typename InstanceT>
+void addInstance(InstancedRenderContext<GeometryT, StyleT, InstanceT> &ctx,
+                 typename InstanceT::Value const &instance) {
+  ctx.instances.push_back(instance);
 }
 
 } // namespace givr
@@ -17003,7 +17723,17 @@ namespace givr {
 namespace style {
 struct GL_LineParameters : public Style<Colour, Width> {};
 
+struct GL_LineUniforms {
+  UniformHandle<vec3f> colour;
+  UniformHandle<mat4f> model;
+
+  GL_LineUniforms() = default;
+  explicit GL_LineUniforms(Program const &p)
+      : colour{p.uniform<vec3f>("colour")}, model{p.uniform<mat4f>("model")} {}
+};
+
 struct GL_Line : public GL_LineParameters {
+  using Uniforms = GL_LineUniforms;
   using Parameters = GL_LineParameters;
   template <typename... Args> GL_Line(Args &&... args) {
     using required_args = std::tuple<Colour>;
@@ -17046,8 +17776,8 @@ typename GeometryT::Data fillBuffers(GeometryT const &g, GL_Line const &) {
 
 template <typename RenderContextT>
 void setLineUniforms(RenderContextT const &ctx,
-                     std::unique_ptr<givr::Program> const &p) {
-  p->setVec3("colour", ctx.params.template value<Colour>());
+                     std::shared_ptr<givr::Program> const &p) {
+  p->set(ctx.uniforms.colour, ctx.params.template value<Colour>());
 }
 std::string linesVertexSource(std::string modelSource);
 std::string linesFragmentSource();
@@ -17056,9 +17786,9 @@ template <typename GeometryT>
 RenderContext<GeometryT, GL_Line> getContext(GeometryT const &,
                                              GL_Line const &l) {
   RenderContext<GeometryT, GL_Line> ctx;
-  ctx.shaderProgram = std::make_unique<Program>(
-      Shader{linesVertexSource(ctx.getModelSource()), GL_VERTEX_SHADER},
-      Shader{linesFragmentSource(), GL_FRAGMENT_SHADER});
+  ctx.shaderProgram =
+      getProgram(linesVertexSource(ctx.getModelSource()), linesFragmentSource());
+  ctx.uniforms = GL_LineUniforms(*ctx.shaderProgram);
   ctx.primitive = getPrimitive<GeometryT>();
   updateStyle(ctx, l);
   return ctx;
@@ -17069,12 +17799,12 @@ void updateStyle(RenderContextT &ctx, GL_Line const &l) {
   ctx.params.set(l.args);
 }
 
-template <typename GeometryT, typename ViewContextT>
-void draw(InstancedRenderContext<GeometryT, GL_Line> &ctx,
+template <typename GeometryT, typename InstanceT, typename ViewContextT>
+void draw(InstancedRenderContext<GeometryT, GL_Line, InstanceT> &ctx,
           ViewContextT const &viewCtx) {
   glEnable(GL_LINE_SMOOTH);
   glLineWidth(ctx.params.template value<Width>());
-  drawInstanced(ctx, viewCtx, [&ctx](std::unique_ptr<Program> const &program) {
+  drawInstanced(ctx, viewCtx, [&ctx](std::shared_ptr<Program> const &program) {
     setLineUniforms(ctx, program);
   });
 }
@@ -17085,9 +17815,9 @@ void draw(RenderContext<GeometryT, GL_Line> &ctx, ViewContextT const &viewCtx,
   glEnable(GL_LINE_SMOOTH);
   glLineWidth(ctx.params.template value<Width>());
   drawArray(ctx, viewCtx,
-            [&ctx, &model](std::unique_ptr<Program> const &program) {
+            [&ctx, &model](std::shared_ptr<Program> const &program) {
               setLineUniforms(ctx, program);
-              program->setMat4("model", model);
+              program->set(ctx.uniforms.model, model);
             });
 }
 
@@ -17107,7 +17837,17 @@ namespace givr {
 namespace style {
 struct NoShadingParameters : public Style<Colour> {};
 
+struct NoShadingUniforms {
+  UniformHandle<vec3f> colour;
+  UniformHandle<mat4f> model;
+
+  NoShadingUniforms() = default;
+  explicit NoShadingUniforms(Program const &p)
+      : colour{p.uniform<vec3f>("colour")}, model{p.uniform<mat4f>("model")} {}
+};
+
 struct NoShading : public NoShadingParameters {
+  using Uniforms = NoShadingUniforms;
   using Parameters = NoShadingParameters;
   template <typename... Args> NoShading(Args &&... args) {
     using required_args = std::tuple<Colour>;
@@ -17133,8 +17873,8 @@ using NoShadingStyle = NoShading;
 
 template <typename RenderContextT>
 void setNoShadingUniforms(RenderContextT const &ctx,
-                          std::unique_ptr<givr::Program> const &p) {
-  p->setVec3("colour", ctx.params.template value<givr::style::Colour>());
+                          std::shared_ptr<givr::Program> const &p) {
+  p->set(ctx.uniforms.colour, ctx.params.template value<givr::style::Colour>());
 }
 
 std::string noShadingVertexSource(std::string modelSource);
@@ -17153,9 +17893,9 @@ RenderContext<GeometryT, NoShading> getContext(GeometryT const &,
                                                NoShading const &f) {
   std::cout << "NoShading" << std::endl;
   RenderContext<GeometryT, NoShading> ctx;
-  ctx.shaderProgram = std::make_unique<Program>(
-      Shader{noShadingVertexSource(ctx.getModelSource()), GL_VERTEX_SHADER},
-      Shader{noShadingFragmentSource(), GL_FRAGMENT_SHADER});
+  ctx.shaderProgram = getProgram(noShadingVertexSource(ctx.getModelSource()),
+                                 noShadingFragmentSource());
+  ctx.uniforms = NoShadingUniforms(*ctx.shaderProgram);
   ctx.primitive = getPrimitive<GeometryT>();
   updateStyle(ctx, f);
   return ctx;
@@ -17166,10 +17906,10 @@ void updateStyle(RenderContextT &ctx, NoShading const &f) {
   ctx.params.set(f.args);
 }
 
-template <typename GeometryT, typename ViewContextT>
-void draw(InstancedRenderContext<GeometryT, NoShading> &ctx,
+template <typename GeometryT, typename InstanceT, typename ViewContextT>
+void draw(InstancedRenderContext<GeometryT, NoShading, InstanceT> &ctx,
           ViewContextT const &viewCtx) {
-  drawInstanced(ctx, viewCtx, [&ctx](std::unique_ptr<Program> const &program) {
+  drawInstanced(ctx, viewCtx, [&ctx](std::shared_ptr<Program> const &program) {
     setNoShadingUniforms(ctx, program);
   });
 }
@@ -17178,9 +17918,9 @@ template <typename GeometryT, typename ViewContextT>
 void draw(RenderContext<GeometryT, NoShading> &ctx, ViewContextT const &viewCtx,
           mat4f model = mat4f(1.f)) {
   drawArray(ctx, viewCtx,
-            [&ctx, &model](std::unique_ptr<Program> const &program) {
+            [&ctx, &model](std::shared_ptr<Program> const &program) {
               setNoShadingUniforms(ctx, program);
-              program->setMat4("model", model);
+              program->set(ctx.uniforms.model, model);
             });
 }
 } // end namespace style
@@ -17203,8 +17943,39 @@ struct T_PhongParameters
                    PhongExponent, PerVertexColour, ShowWireFrame,
                    WireFrameColour, WireFrameWidth, GenerateNormals> {};
 
+struct PhongUniforms {
+  UniformHandle<int> colorTexture;
+  UniformHandle<vec3f> colour;
+  UniformHandle<vec3f> lightPosition;
+  UniformHandle<float> ambientFactor;
+  UniformHandle<float> specularFactor;
+  UniformHandle<float> phongExponent;
+  UniformHandle<bool> perVertexColour;
+  UniformHandle<bool> showWireFrame;
+  UniformHandle<vec3f> wireFrameColour;
+  UniformHandle<float> wireFrameWidth;
+  UniformHandle<bool> generateNormals;
+  UniformHandle<mat4f> model;
+
+  PhongUniforms() = default;
+  explicit PhongUniforms(Program const &p)
+      : colorTexture{p.uniform<int>("colorTexture")},
+        colour{p.uniform<vec3f>("colour")},
+        lightPosition{p.uniform<vec3f>("lightPosition")},
+        ambientFactor{p.uniform<float>("ambientFactor")},
+        specularFactor{p.uniform<float>("specularFactor")},
+        phongExponent{p.uniform<float>("phongExponent")},
+        perVertexColour{p.uniform<bool>("perVertexColour")},
+        showWireFrame{p.uniform<bool>("showWireFrame")},
+        wireFrameColour{p.uniform<vec3f>("wireFrameColour")},
+        wireFrameWidth{p.uniform<float>("wireFrameWidth")},
+        generateNormals{p.uniform<bool>("generateNormals")},
+        model{p.uniform<mat4f>("model")} {}
+};
+
 template <typename ColorSrc> struct T_Phong : T_PhongParameters<ColorSrc> {
   using Parameters = T_PhongParameters<ColorSrc>;
+  using Uniforms = PhongUniforms;
   template <typename... T_PhongArgs> T_Phong(T_PhongArgs &&... args) {
     using required_args = std::tuple<LightPosition, ColorSrc>;
 
@@ -17245,28 +18016,28 @@ std::string phongFragmentSource(bool usingTexture, bool hasColours);
 
 template <typename RenderContextT>
 void setPhongUniforms(RenderContextT const &ctx,
-                      std::unique_ptr<givr::Program> const &p) {
+                      std::shared_ptr<givr::Program> const &p) {
   using namespace givr::style;
   if constexpr (std::is_same<RenderContextT, T_Phong<ColorTexture>>::value) {
     givr::Texture texture = ctx.template value<ColorTexture>();
     if (GLuint(texture)) {
       glActiveTexture(GL_TEXTURE1);
       texture.bind(GL_TEXTURE_2D);
-      p->setInt("colorTexture", 1);
+      p->set(ctx.uniforms.colorTexture, 1);
       glActiveTexture(GL_TEXTURE0);
     }
   } else {
-    p->setVec3("colour", ctx.params.template value<Colour>());
+    p->set(ctx.uniforms.colour, ctx.params.template value<Colour>());
   }
-  p->setVec3("lightPosition", ctx.params.template value<LightPosition>());
-  p->setFloat("ambientFactor", ctx.params.template value<AmbientFactor>());
-  p->setFloat("specularFactor", ctx.params.template value<SpecularFactor>());
-  p->setFloat("phongExponent", ctx.params.template value<PhongExponent>());
-  p->setBool("perVertexColour", ctx.params.template value<PerVertexColour>());
-  p->setBool("showWireFrame", ctx.params.template value<ShowWireFrame>());
-  p->setVec3("wireFrameColour", ctx.params.template value<WireFrameColour>());
-  p->setFloat("wireFrameWidth", ctx.params.template value<WireFrameWidth>());
-  p->setBool("generateNormals", ctx.params.template value<GenerateNormals>());
+  p->set(ctx.uniforms.lightPosition, ctx.params.template value<LightPosition>());
+  p->set(ctx.uniforms.ambientFactor, ctx.params.template value<AmbientFactor>());
+  p->set(ctx.uniforms.specularFactor, ctx.params.template value<SpecularFactor>());
+  p->set(ctx.uniforms.phongExponent, ctx.params.template value<PhongExponent>());
+  p->set(ctx.uniforms.perVertexColour, ctx.params.template value<PerVertexColour>());
+  p->set(ctx.uniforms.showWireFrame, ctx.params.template value<ShowWireFrame>());
+  p->set(ctx.uniforms.wireFrameColour, ctx.params.template value<WireFrameColour>());
+  p->set(ctx.uniforms.wireFrameWidth, ctx.params.template value<WireFrameWidth>());
+  p->set(ctx.uniforms.generateNormals, ctx.params.template value<GenerateNormals>());
 }
 
 template <typename GeometryT, typename ColorSrc>
@@ -17295,16 +18066,14 @@ typename GeometryT::Data fillBuffers(GeometryT const &g,
 }
 
 template <typename GeometryT, typename StyleT>
-std::unique_ptr<Program> getPhongShaderProgram(std::string modelSource) {
+std::shared_ptr<Program> getPhongShaderProgram(std::string modelSource) {
   constexpr bool _hasNormals = hasNormals<GeometryT>::value;
   constexpr bool _hasColours = hasColours<GeometryT>::value;
   constexpr bool _useTex = std::is_same<StyleT, T_Phong<ColorTexture>>::value;
-  return std::make_unique<Program>(
-      Shader{phongVertexSource(modelSource, _useTex, _hasNormals, _hasColours),
-             GL_VERTEX_SHADER},
-      Shader{phongGeometrySource(_useTex, _hasNormals, _hasColours),
-             GL_GEOMETRY_SHADER},
-      Shader{phongFragmentSource(_useTex, _hasColours), GL_FRAGMENT_SHADER});
+  return getProgram(
+      phongVertexSource(modelSource, _useTex, _hasNormals, _hasColours),
+      phongGeometrySource(_useTex, _hasNormals, _hasColours),
+      phongFragmentSource(_useTex, _hasColours));
 }
 
 template <typename GeometryT, typename ColorSrc>
@@ -17314,17 +18083,19 @@ getContext(GeometryT const &, T_Phong<ColorSrc> const &p) {
   RenderContext<GeometryT, T_Phong<ColorSrc>> ctx;
   ctx.shaderProgram =
       getPhongShaderProgram<GeometryT, T_Phong<ColorSrc>>(ctx.getModelSource());
+  ctx.uniforms = PhongUniforms(*ctx.shaderProgram);
   ctx.primitive = getPrimitive<GeometryT>();
   updateStyle(ctx, p);
   return std::move(ctx);
 }
 
-template <typename GeometryT, typename StyleT>
-InstancedRenderContext<GeometryT, StyleT> getInstancedContext(GeometryT const &,
-                                                              StyleT const &p) {
-  InstancedRenderContext<GeometryT, StyleT> ctx;
+template <typename GeometryT, typename StyleT, typename InstanceT>
+InstancedRenderContext<GeometryT, StyleT, InstanceT>
+getInstancedContext(GeometryT const &, StyleT const &p, InstanceT) {
+  InstancedRenderContext<GeometryT, StyleT, InstanceT> ctx;
   ctx.shaderProgram =
       getPhongShaderProgram<GeometryT, StyleT>(ctx.getModelSource());
+  ctx.uniforms = typename StyleT::Uniforms(*ctx.shaderProgram);
   ctx.primitive = getPrimitive<GeometryT>();
   updateStyle(ctx, p);
   return std::move(ctx);
@@ -17335,15 +18106,28 @@ void updateStyle(RenderContextT &ctx, T_Phong<ColorSrc> const &p) {
   ctx.params.set(p.args);
 }
 
+// Fills in the vertex normals of a surface mesh unless the style generates
+// face normals in its geometry shader, in which case the per-vertex pass and
+// the normal upload are skipped entirely.
+template <typename ColorSrc>
+void updateNormals(geometry::SurfaceMesh &mesh, T_Phong<ColorSrc> const &p) {
+  if (p.template value<GenerateNormals>().value()) {
+    mesh.normals().clear();
+  } else {
+    mesh.computeNormals();
+  }
+}
+
 // TODO: come up with a better way to not duplicate OpenGL state setup
-template <typename GeometryT, typename ViewContextT, typename ColorSrc>
-void draw(InstancedRenderContext<GeometryT, T_Phong<ColorSrc>> &ctx,
+template <typename GeometryT, typename InstanceT, typename ViewContextT,
+          typename ColorSrc>
+void draw(InstancedRenderContext<GeometryT, T_Phong<ColorSrc>, InstanceT> &ctx,
           ViewContextT const &viewCtx) {
   glEnable(GL_MULTISAMPLE);
   glEnable(GL_DEPTH_TEST);
   glEnable(GL_BLEND);
   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-  drawInstanced(ctx, viewCtx, [&ctx](std::unique_ptr<Program> const &program) {
+  drawInstanced(ctx, viewCtx, [&ctx](std::shared_ptr<Program> const &program) {
     setPhongUniforms(ctx, program);
   });
 }
@@ -17356,9 +18140,9 @@ void draw(RenderContext<GeometryT, T_Phong<ColorSrc>> &ctx,
   glEnable(GL_BLEND);
   glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
   drawArray(ctx, viewCtx,
-            [&ctx, &model](std::unique_ptr<Program> const &program) {
+            [&ctx, &model](std::shared_ptr<Program> const &program) {
               setPhongUniforms(ctx, program);
-              program->setMat4("model", model);
+              program->set(ctx.uniforms.model, model);
             });
 }
 
@@ -17373,4 +18157,160 @@ using Phong = T_Phong<Colour>;
 //------------------------------------------------------------------------------
 // END phong.h
 //------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------
+// Start impostor.h
+//------------------------------------------------------------------------------
+
+#include <string>
+
+//------------------------------------------------------------------------------
+// Draws every point as a lit sphere. Each point is rasterized as a single
+// screen aligned sprite that covers the sphere, and the fragment shader casts
+// a ray against the sphere to find its surface, normal and depth. No sphere
+// mesh is needed, so the cost is one vertex per particle.
+//
+// Example Code:
+// SphereImpostor style(Colour(1.f, 0.f, 1.f), LightPosition(100.f, 100.f,
+// 100.f), PointRadius(0.2f)); PointCloud points; points.vertices() = ...;
+// auto spheres = createRenderable(points, style);
+// draw(spheres, view);
+//------------------------------------------------------------------------------
+namespace givr {
+namespace style {
+struct SphereImpostorParameters
+    : public Style<Colour, LightPosition, PointRadius, AmbientFactor,
+                   SpecularFactor, PhongExponent, PerVertexColour> {};
+
+struct SphereImpostorUniforms {
+  UniformHandle<vec3f> colour;
+  UniformHandle<vec3f> lightPosition;
+  UniformHandle<float> pointRadius;
+  UniformHandle<float> ambientFactor;
+  UniformHandle<float> specularFactor;
+  UniformHandle<float> phongExponent;
+  UniformHandle<bool> perVertexColour;
+  UniformHandle<mat4f> model;
+  UniformHandle<mat4f> inverseProjection;
+  UniformHandle<vec4f> viewport;
+
+  SphereImpostorUniforms() = default;
+  explicit SphereImpostorUniforms(Program const &p)
+      : colour{p.uniform<vec3f>("colour")},
+        lightPosition{p.uniform<vec3f>("lightPosition")},
+        pointRadius{p.uniform<float>("pointRadius")},
+        ambientFactor{p.uniform<float>("ambientFactor")},
+        specularFactor{p.uniform<float>("specularFactor")},
+        phongExponent{p.uniform<float>("phongExponent")},
+        perVertexColour{p.uniform<bool>("perVertexColour")},
+        model{p.uniform<mat4f>("model")},
+        inverseProjection{p.uniform<mat4f>("inverseProjection")},
+        viewport{p.uniform<vec4f>("viewport")} {}
+};
+
+struct SphereImpostor : public SphereImpostorParameters {
+  using Parameters = SphereImpostorParameters;
+  using Uniforms = SphereImpostorUniforms;
+  template <typename... Args> SphereImpostor(Args &&... args) {
+    using required_args = std::tuple<Colour, LightPosition>;
+
+    using namespace utility;
+    static_assert(!has_duplicate_types<Args...>,
+                  "The arguments you passed in have duplicate parameters");
+
+    static_assert(is_subset_of<required_args, std::tuple<Args...>> &&
+                      is_subset_of<std::tuple<Args...>, SphereImpostor::Args> &&
+                      sizeof...(args) <=
+                          std::tuple_size<SphereImpostor::Args>::value,
+                  "You have provided incorrect parameters for SphereImpostor. "
+                  "Colour and LightPosition are required. PointRadius, "
+                  "AmbientFactor, SpecularFactor, PhongExponent and "
+                  "PerVertexColour are optional.");
+
+    set(PointRadius(1.f));
+    set(AmbientFactor(0.05f));
+    set(SpecularFactor(0.3f));
+    set(PhongExponent(8.0f));
+    set(PerVertexColour(false));
+    set(std::forward<Args>(args)...);
+  }
+};
+
+std::string sphereImpostorVertexSource(std::string modelSource, bool hasRadii,
+                                       bool hasColours);
+std::string sphereImpostorFragmentSource(bool hasColours);
+
+template <typename GeometryT>
+typename GeometryT::Data fillBuffers(GeometryT const &g,
+                                     SphereImpostor const &) {
+  static_assert(givr::isPointBased<GeometryT>(),
+                "The SphereImpostor style requires POINTS for the primitive "
+                "type. The geometry you use is not of this type");
+  static_assert(hasVertices<GeometryT>::value,
+                "The SphereImpostor style requires vertices. The geometry you "
+                "are using does not provide them.");
+  return generateGeometry(g);
+}
+
+template <typename RenderContextT>
+void setSphereImpostorUniforms(RenderContextT const &ctx,
+                               std::shared_ptr<givr::Program> const &p) {
+  p->set(ctx.uniforms.colour, ctx.params.template value<Colour>());
+  p->set(ctx.uniforms.lightPosition, ctx.params.template value<LightPosition>());
+  p->set(ctx.uniforms.pointRadius, ctx.params.template value<PointRadius>());
+  p->set(ctx.uniforms.ambientFactor, ctx.params.template value<AmbientFactor>());
+  p->set(ctx.uniforms.specularFactor, ctx.params.template value<SpecularFactor>());
+  p->set(ctx.uniforms.phongExponent, ctx.params.template value<PhongExponent>());
+  p->set(ctx.uniforms.perVertexColour, ctx.params.template value<PerVertexColour>());
+}
+
+template <typename GeometryT>
+RenderContext<GeometryT, SphereImpostor> getContext(GeometryT const &,
+                                                    SphereImpostor const &s) {
+  RenderContext<GeometryT, SphereImpostor> ctx;
+  ctx.shaderProgram = getProgram(
+      sphereImpostorVertexSource(ctx.getModelSource(),
+                                 hasRadii<GeometryT>::value,
+                                 hasColours<GeometryT>::value),
+      sphereImpostorFragmentSource(hasColours<GeometryT>::value));
+  ctx.uniforms = SphereImpostorUniforms(*ctx.shaderProgram);
+  ctx.primitive = getPrimitive<GeometryT>();
+  updateStyle(ctx, s);
+  return ctx;
+}
+
+template <typename RenderContextT>
+void updateStyle(RenderContextT &ctx, SphereImpostor const &s) {
+  ctx.params.set(s.args);
+}
+
+template <typename GeometryT, typename ViewContextT>
+void draw(RenderContext<GeometryT, SphereImpostor> &ctx,
+          ViewContextT const &viewCtx, mat4f const model = mat4f(1.f)) {
+  // The sprite size and the rays are both derived from the viewport, which
+  // is whatever the caller last set.
+  GLint viewport[4];
+  glGetIntegerv(GL_VIEWPORT, viewport);
+  mat4f inverseProjection =
+      glm::inverse(viewCtx.projection.projectionMatrix());
+
+  glEnable(GL_PROGRAM_POINT_SIZE);
+  glEnable(GL_MULTISAMPLE);
+  glEnable(GL_DEPTH_TEST);
+  drawArray(ctx, viewCtx,
+            [&](std::shared_ptr<Program> const &program) {
+              setSphereImpostorUniforms(ctx, program);
+              program->set(ctx.uniforms.model, model);
+              program->set(ctx.uniforms.inverseProjection, inverseProjection);
+              program->set(ctx.uniforms.viewport,
+                           vec4f(viewport[0], viewport[1], viewport[2],
+                                 viewport[3]));
+            });
+}
+
+} // end namespace style
+} // end namespace givr
+//------------------------------------------------------------------------------
+// END impostor.h
+//------------------------------------------------------------------------------
 //GIVR for Winter 2023
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include "allocation_tracker.hpp"
+
+#ifdef SIMULATION_ALLOCATION_TRACKING
+
+#include <cstdlib>
+#include <new>
+
+namespace allocation {
+	namespace {
+		//Constant initialised, so it is safe to touch from inside operator new on any thread
+		thread_local Counts counts;
+
+		void* allocate(std::size_t size) {
+			counts.allocations++;
+			counts.bytes += size;
+			return std::malloc(size ? size : 1);
+		}
+
+		void* allocate_aligned(std::size_t size, std::size_t alignment) {
+			counts.allocations++;
+			counts.bytes += size;
+#ifdef _WIN32
+			return _aligned_malloc(size ? size : 1, alignment);
+#else
+			//aligned_alloc needs the size to be a multiple of the alignment
+			std::size_t rounded = (size + alignment - 1) / alignment * alignment;
+			return std::aligned_alloc(alignment, rounded ? rounded : alignment);
+#endif
+		}
+
+		void release(void* p) {
+			if (p) {
+				counts.frees++;
+				std::free(p);
+			}
+		}
+
+		void release_aligned(void* p) {
+			if (p) {
+				counts.frees++;
+#ifdef _WIN32
+				_aligned_free(p);
+#else
+				std::free(p);
+#endif
+			}
+		}
+	}
+
+	Counts thread_counts() {
+		return counts;
+	}
+} // namespace allocation
+
+void* operator new(std::size_t size) {
+	if (void* p = allocation::allocate(size)) return p;
+	throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) {
+	if (void* p = allocation::allocate(size)) return p;
+	throw std::bad_alloc();
+}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+	return allocation::allocate(size);
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+	return allocation::allocate(size);
+}
+void* operator new(std::size_t size, std::align_val_t alignment) {
+	if (void* p = allocation::allocate_aligned(size, std::size_t(alignment))) return p;
+	throw std::bad_alloc();
+}
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+	if (void* p = allocation::allocate_aligned(size, std::size_t(alignment))) return p;
+	throw std::bad_alloc();
+}
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+	return allocation::allocate_aligned(size, std::size_t(alignment));
+}
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+	return allocation::allocate_aligned(size, std::size_t(alignment));
+}
+
+void operator delete(void* p) noexcept { allocation::release(p); }
+void operator delete[](void* p) noexcept { allocation::release(p); }
+void operator delete(void* p, std::size_t) noexcept { allocation::release(p); }
+void operator delete[](void* p, std::size_t) noexcept { allocation::release(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { allocation::release(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { allocation::release(p); }
+void operator delete(void* p, std::align_val_t) noexcept { allocation::release_aligned(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { allocation::release_aligned(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { allocation::release_aligned(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { allocation::release_aligned(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { allocation::release_aligned(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { allocation::release_aligned(p); }
+
+#endif
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+
+//Counts heap allocations per thread by replacing the global operator new and delete. Only
+//built in with SIMULATION_ALLOCATION_TRACKING (the ENABLE_ALLOCATION_TRACKING CMake option),
+//otherwise the counts are always zero.
+namespace allocation {
+	struct Counts {
+		std::uint64_t allocations = 0;
+		std::uint64_t frees = 0;
+		std::uint64_t bytes = 0;
+	};
+
+#ifdef SIMULATION_ALLOCATION_TRACKING
+	constexpr bool tracking = true;
+	//Allocations made by the calling thread since it started
+	Counts thread_counts();
+#else
+	constexpr bool tracking = false;
+	inline Counts thread_counts() { return {}; }
+#endif
+
+	//Allocations made by the calling thread during its lifetime
+	class Scope {
+	public:
+		Scope() : start(thread_counts()) {}
+
+		Counts counts() const {
+			Counts now = thread_counts();
+			return { now.allocations - start.allocations, now.frees - start.frees, now.bytes - start.bytes };
+		}
+
+	private:
+		Counts start;
+	};
+} // namespace allocation
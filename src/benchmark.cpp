@@ -0,0 +1,248 @@
+#include "benchmark.hpp"
+#include "allocation_tracker.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#ifdef __linux__
+#include <cerrno>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace benchmark {
+	namespace {
+#ifdef __linux__
+		perf_event_attr counter_attr(PerfCounters::Counter counter) {
+			perf_event_attr attr;
+			std::memset(&attr, 0, sizeof(attr));
+			attr.size = sizeof(attr);
+			attr.disabled = 1;
+			//User space only, which is all the step does and is allowed at perf_event_paranoid 2
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+			switch (counter) {
+			case PerfCounters::Cycles:
+				attr.type = PERF_TYPE_HARDWARE;
+				attr.config = PERF_COUNT_HW_CPU_CYCLES;
+				break;
+			case PerfCounters::Instructions:
+				attr.type = PERF_TYPE_HARDWARE;
+				attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+				break;
+			case PerfCounters::L1DMisses:
+				attr.type = PERF_TYPE_HW_CACHE;
+				attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+				break;
+			case PerfCounters::LLCMisses:
+				attr.type = PERF_TYPE_HW_CACHE;
+				attr.config = PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+				break;
+			case PerfCounters::BranchMisses:
+			default:
+				attr.type = PERF_TYPE_HARDWARE;
+				attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+				break;
+			}
+			return attr;
+		}
+#endif
+
+		//Frames rendered before the allocations are counted, while the renderables settle
+		constexpr std::size_t render_warm_up = 10;
+		constexpr std::size_t render_frames = 100;
+
+		void print_allocations(const char* label, const allocation::Counts& counts, std::size_t repeats) {
+			if (allocation::tracking) {
+				std::printf("  %-16s %14.1f %14s (%llu bytes)\n", label, double(counts.allocations) / repeats, "",
+					(unsigned long long)counts.bytes);
+			} else {
+				std::printf("  %-16s %14s\n", label, "n/a");
+			}
+		}
+
+		void print_row(const char* label, double per_step, double springs) {
+			if (std::isnan(per_step)) {
+				std::printf("  %-16s %14s %14s\n", label, "n/a", "n/a");
+			} else {
+				std::printf("  %-16s %14.1f %14.3f\n", label, per_step, per_step / springs);
+			}
+		}
+	}
+
+	const char* PerfCounters::name(Counter counter) {
+		switch (counter) {
+		case Cycles: return "cycles";
+		case Instructions: return "instructions";
+		case L1DMisses: return "L1D misses";
+		case LLCMisses: return "LLC misses";
+		case BranchMisses: return "branch misses";
+		default: return "";
+		}
+	}
+
+	PerfCounters::PerfCounters() {
+		fds.fill(-1);
+#ifdef __linux__
+		for (int c = 0; c < Count; c++) {
+			perf_event_attr attr = counter_attr(Counter(c));
+			fds[c] = int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+			if (fds[c] < 0 && first_error.empty()) {
+				first_error = std::string(name(Counter(c))) + ": " + std::strerror(errno);
+				if (errno == EACCES || errno == EPERM) {
+					first_error += " (see /proc/sys/kernel/perf_event_paranoid)";
+				}
+			}
+		}
+#else
+		first_error = "hardware counters are only read on Linux";
+#endif
+	}
+
+	PerfCounters::~PerfCounters() {
+#ifdef __linux__
+		for (int fd : fds) {
+			if (fd >= 0) {
+				close(fd);
+			}
+		}
+#endif
+	}
+
+	bool PerfCounters::any_available() const {
+		for (int fd : fds) {
+			if (fd >= 0) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void PerfCounters::start() {
+#ifdef __linux__
+		for (int fd : fds) {
+			if (fd >= 0) {
+				ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+				ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+			}
+		}
+#endif
+	}
+
+	void PerfCounters::stop() {
+#ifdef __linux__
+		for (int fd : fds) {
+			if (fd >= 0) {
+				ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+			}
+		}
+#endif
+	}
+
+	std::array<double, PerfCounters::Count> PerfCounters::read() const {
+		std::array<double, Count> counts;
+		counts.fill(std::numeric_limits<double>::quiet_NaN());
+#ifdef __linux__
+		for (int c = 0; c < Count; c++) {
+			//value, time enabled, time running
+			std::uint64_t values[3] = {};
+			if (fds[c] < 0 || ::read(fds[c], values, sizeof(values)) != sizeof(values) || values[2] == 0) {
+				continue;
+			}
+			counts[c] = double(values[0]) * double(values[1]) / double(values[2]);
+		}
+#endif
+		return counts;
+	}
+
+	int run(const ModelFactory& create_model, std::size_t steps) {
+		using clock = std::chrono::steady_clock;
+		const std::size_t warm_up = std::max<std::size_t>(steps / 10, 1);
+
+		PerfCounters counters;
+		bool allocation_free = true;
+		if (!allocation::tracking) {
+			std::printf("Allocation tracking not built in (ENABLE_ALLOCATION_TRACKING)\n");
+		}
+		if (!counters.any_available()) {
+			std::printf("Hardware counters unavailable (%s), reporting time only\n", counters.error().c_str());
+		} else if (!counters.error().empty()) {
+			std::printf("Some hardware counters unavailable (%s)\n", counters.error().c_str());
+		}
+
+		for (const std::pair<const imgui_panel::ModelType, const char*>& entry : imgui_panel::type_to_name_map) {
+			std::unique_ptr<simulation::models::GenericModel> model = create_model(entry.first);
+			float dt = imgui_panel::dt_simulation;
+			double springs = double(std::max<std::size_t>(model->spring_count(), 1));
+
+			for (std::size_t i = 0; i < warm_up; i++) {
+				model->step(dt);
+			}
+			profiler::collect();
+			allocation::Scope step_scope;
+			counters.start();
+			clock::time_point start = clock::now();
+			for (std::size_t i = 0; i < steps; i++) {
+				model->step(dt);
+			}
+			clock::time_point end = clock::now();
+			counters.stop();
+			allocation::Counts step_allocations = step_scope.counts();
+
+			//render() on its own, without the counters
+			simulation::models::ModelViewContext view = givr::camera::View(givr::camera::TurnTable(), givr::camera::Perspective());
+			for (std::size_t i = 0; i < render_warm_up; i++) {
+				model->render(view);
+			}
+			glFinish();
+			profiler::collect();
+			allocation::Scope render_scope;
+			clock::time_point render_start = clock::now();
+			for (std::size_t i = 0; i < render_frames; i++) {
+				model->render(view);
+			}
+			clock::time_point render_end = clock::now();
+			allocation::Counts render_allocations = render_scope.counts();
+			glFinish();
+			profiler::collect();
+
+			std::array<double, PerfCounters::Count> counts = counters.read();
+			double step_ns = std::chrono::duration<double, std::nano>(end - start).count() / steps;
+			std::printf("\n%s: %zu masses, %zu springs, %zu steps of dt %g (after %zu warm-up)\n",
+				entry.second, model->mass_count(), model->spring_count(), steps, dt, warm_up);
+			std::printf("  %-16s %14s %14s\n", "", "per step", "per spring");
+			print_row("time (ns)", step_ns, springs);
+			for (int c = 0; c < PerfCounters::Count; c++) {
+				print_row(PerfCounters::name(PerfCounters::Counter(c)), counts[c] / steps, springs);
+			}
+			if (!std::isnan(counts[PerfCounters::Cycles]) && !std::isnan(counts[PerfCounters::Instructions])) {
+				std::printf("  %-16s %14.2f\n", "IPC", counts[PerfCounters::Instructions] / counts[PerfCounters::Cycles]);
+			}
+			print_allocations("allocations", step_allocations, steps);
+
+			double render_ns = std::chrono::duration<double, std::nano>(render_end - render_start).count() / render_frames;
+			std::printf("  %-16s %14s\n", "", "per frame");
+			std::printf("  %-16s %14.1f\n", "render (ns)", render_ns);
+			print_allocations("allocations", render_allocations, render_frames);
+
+			if (step_allocations.allocations > 0) {
+				std::printf("FAIL: %s step() allocated %llu times\n", entry.second, (unsigned long long)step_allocations.allocations);
+				allocation_free = false;
+			}
+			if (render_allocations.allocations > 0) {
+				std::printf("FAIL: %s render() allocated %llu times after warming up\n", entry.second, (unsigned long long)render_allocations.allocations);
+				allocation_free = false;
+			}
+		}
+		return allocation_free ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+} // namespace benchmark
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "imgui_panel.hpp"
+#include "models.hpp"
+
+namespace benchmark {
+	//Hardware counters of the calling thread, read with perf_event_open on Linux. Counters the
+	//kernel refuses (or every counter elsewhere) are reported as unavailable.
+	class PerfCounters {
+	public:
+		enum Counter { Cycles, Instructions, L1DMisses, LLCMisses, BranchMisses, Count };
+		static const char* name(Counter counter);
+
+		PerfCounters();
+		~PerfCounters();
+
+		PerfCounters(const PerfCounters&) = delete;
+		PerfCounters& operator=(const PerfCounters&) = delete;
+
+		bool any_available() const;
+		//Why the first unavailable counter could not be opened
+		const std::string& error() const { return first_error; }
+
+		void start();
+		void stop();
+		//Counts since start(), scaled up if the kernel multiplexed them. NaN when unavailable.
+		std::array<double, Count> read() const;
+
+	private:
+		std::array<int, Count> fds;
+		std::string first_error;
+	};
+
+	using ModelFactory = std::function<std::unique_ptr<simulation::models::GenericModel>(imgui_panel::ModelType)>;
+
+	//Steps each model without rendering and prints the time and counters per step and per
+	//spring, then times render() on its own. The factory also sets imgui_panel::dt_simulation
+	//for the model, which is the dt stepped. Needs a current GL context, since the models
+	//create their renderables.
+	//With allocation tracking built in it fails (returns EXIT_FAILURE) if step() or render(),
+	//after warming up, allocate on the heap.
+	int run(const ModelFactory& create_model, std::size_t steps);
+} // namespace benchmark
@@ -0,0 +1,131 @@
+#include "checkpoint.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+namespace simulation {
+	namespace checkpoint {
+		namespace {
+			const char magic[8] = { 'M', 'S', 'S', 'C', 'H', 'K', 'P', 'T' };
+			constexpr std::uint32_t byte_order_mark = 0x01020304;
+
+			std::uint64_t align(std::uint64_t offset) {
+				return (offset + 15) & ~std::uint64_t(15);
+			}
+		}
+
+		bool write(const std::string& path, std::uint32_t model_type, double time, float dt, const State& state) {
+			Header header;
+			std::memset(&header, 0, sizeof(header));
+			std::memcpy(header.magic, magic, sizeof(magic));
+			header.version = version;
+			header.byte_order = byte_order_mark;
+			header.mass_size = sizeof(primatives::Mass);
+			header.spring_size = sizeof(SpringRecord);
+			header.model_type = model_type;
+			header.mass_count = std::uint32_t(state.masses.size());
+			header.spring_count = std::uint32_t(state.springs.size());
+			header.parameter_count = std::uint32_t(state.parameters.size());
+			header.time = time;
+			header.dt = dt;
+			header.masses_offset = align(sizeof(Header));
+			header.springs_offset = align(header.masses_offset + state.masses.size() * sizeof(primatives::Mass));
+			header.parameters_offset = align(header.springs_offset + state.springs.size() * sizeof(SpringRecord));
+			header.file_size = header.parameters_offset + state.parameters.size() * sizeof(float);
+
+			//Laid out in memory first so the file gets one sequential write
+			std::vector<unsigned char> bytes(header.file_size, 0);
+			std::memcpy(bytes.data(), &header, sizeof(header));
+			if (!state.masses.empty()) {
+				std::memcpy(bytes.data() + header.masses_offset, state.masses.data(), state.masses.size() * sizeof(primatives::Mass));
+			}
+			if (!state.springs.empty()) {
+				std::memcpy(bytes.data() + header.springs_offset, state.springs.data(), state.springs.size() * sizeof(SpringRecord));
+			}
+			if (!state.parameters.empty()) {
+				std::memcpy(bytes.data() + header.parameters_offset, state.parameters.data(), state.parameters.size() * sizeof(float));
+			}
+
+			std::string temporary = path + ".tmp";
+			std::FILE* file = std::fopen(temporary.c_str(), "wb");
+			if (!file) {
+				return false;
+			}
+			bool written = std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+			written = (std::fclose(file) == 0) && written;
+			if (written) {
+				//rename does not replace an existing file everywhere
+				std::remove(path.c_str());
+				written = std::rename(temporary.c_str(), path.c_str()) == 0;
+			}
+			if (!written) {
+				std::remove(temporary.c_str());
+			}
+			return written;
+		}
+
+		bool Snapshot::open(const std::string& path) {
+			open_error.clear();
+			if (!file.open(path)) {
+				open_error = "cannot open " + path;
+				return false;
+			}
+			const Header* h = reinterpret_cast<const Header*>(file.data());
+			if (file.size() < sizeof(Header) || std::memcmp(h->magic, magic, sizeof(magic)) != 0) {
+				open_error = path + " is not a checkpoint";
+			} else if (h->version != version || h->byte_order != byte_order_mark
+				|| h->mass_size != sizeof(primatives::Mass) || h->spring_size != sizeof(SpringRecord)) {
+				open_error = path + " was written by an incompatible version";
+			} else if (h->file_size != file.size()) {
+				open_error = path + " is truncated";
+			} else if (!file.holds<primatives::Mass>(h->masses_offset, h->mass_count)
+				|| !file.holds<SpringRecord>(h->springs_offset, h->spring_count)
+				|| !file.holds<float>(h->parameters_offset, h->parameter_count)) {
+				open_error = path + " is damaged";
+			}
+			if (!open_error.empty()) {
+				file.close();
+				return false;
+			}
+			return true;
+		}
+
+		void save_masses(const std::vector<primatives::Mass>& masses, const std::vector<primatives::Spring>& springs, State& state) {
+			state.masses = masses;
+			state.springs.clear();
+			state.springs.reserve(springs.size());
+			for (const primatives::Spring& spring : springs) {
+				state.springs.push_back({
+					std::uint32_t(spring.mass_a - masses.data()),
+					std::uint32_t(spring.mass_b - masses.data()),
+					spring.k, spring.r, spring.l, spring.c });
+			}
+		}
+
+		bool restore_masses(const Snapshot& snapshot, std::vector<primatives::Mass>& masses, std::vector<primatives::Spring>& springs) {
+			const Header& header = snapshot.header();
+			if (header.mass_count != masses.size() || header.spring_count != springs.size()) {
+				return false;
+			}
+			const SpringRecord* records = snapshot.springs();
+			for (std::uint32_t n = 0; n < header.spring_count; n++) {
+				if (records[n].mass_a >= header.mass_count || records[n].mass_b >= header.mass_count) {
+					return false;
+				}
+			}
+
+			std::memcpy(masses.data(), snapshot.masses(), masses.size() * sizeof(primatives::Mass));
+			springs.assign(header.spring_count, primatives::Spring());
+			for (std::uint32_t n = 0; n < header.spring_count; n++) {
+				primatives::Spring& spring = springs[n];
+				spring.mass_a = &masses[records[n].mass_a];
+				spring.mass_b = &masses[records[n].mass_b];
+				spring.k = records[n].k;
+				spring.r = records[n].r;
+				spring.l = records[n].l;
+				spring.c = records[n].c;
+			}
+			return true;
+		}
+	} // namespace checkpoint
+} // namespace simulation
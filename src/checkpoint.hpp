@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "mapped_file.hpp"
+#include "models.hpp"
+
+//Binary snapshots of a model's full state. A file is one header followed by the mass array, the
+//spring topology (as mass indices) and the model's parameters, each at the offset the header
+//gives. It is written with a single write and read back through a memory mapping, so loading
+//copies the arrays straight out of the file without parsing anything.
+namespace simulation {
+	namespace checkpoint {
+		constexpr std::uint32_t version = 1;
+
+		struct SpringRecord {
+			std::uint32_t mass_a;
+			std::uint32_t mass_b;
+			float k;
+			float r;
+			float l;
+			float c;
+		};
+
+		//The masses are stored as they are in memory
+		static_assert(std::is_trivially_copyable<primatives::Mass>::value, "Masses are written byte for byte");
+
+		struct Header {
+			char magic[8];
+			std::uint32_t version;
+			//Rejects files from a machine with the other byte order
+			std::uint32_t byte_order;
+			std::uint32_t mass_size;
+			std::uint32_t spring_size;
+			//imgui_panel::ModelType of the model
+			std::uint32_t model_type;
+			std::uint32_t mass_count;
+			std::uint32_t spring_count;
+			std::uint32_t parameter_count;
+			double time;
+			float dt;
+			std::uint32_t reserved;
+			std::uint64_t masses_offset;
+			std::uint64_t springs_offset;
+			std::uint64_t parameters_offset;
+			std::uint64_t file_size;
+		};
+
+		//What a model fills in to be saved
+		struct State {
+			std::vector<primatives::Mass> masses;
+			std::vector<SpringRecord> springs;
+			std::vector<float> parameters;
+		};
+
+		//Writes the state to path through a temporary file, so an existing snapshot is only
+		//replaced by a complete one
+		bool write(const std::string& path, std::uint32_t model_type, double time, float dt, const State& state);
+
+		//A mapped snapshot, with views straight into the file
+		class Snapshot {
+		public:
+			//False (with error() saying why) if the file is missing, truncated or from another version
+			bool open(const std::string& path);
+			const std::string& error() const { return open_error; }
+
+			const Header& header() const { return *reinterpret_cast<const Header*>(file.data()); }
+			const primatives::Mass* masses() const { return at<primatives::Mass>(header().masses_offset); }
+			const SpringRecord* springs() const { return at<SpringRecord>(header().springs_offset); }
+			const float* parameters() const { return at<float>(header().parameters_offset); }
+
+		private:
+			template <typename T>
+			const T* at(std::uint64_t offset) const { return reinterpret_cast<const T*>(file.data() + offset); }
+
+			MappedFile file;
+			std::string open_error;
+		};
+
+		//Helpers for the models, which keep their springs as mass pointers
+		void save_masses(const std::vector<primatives::Mass>& masses, const std::vector<primatives::Spring>& springs, State& state);
+		//Fails if the snapshot has a different number of masses or springs than the model, whose
+		//spring lines were drawn from its own topology
+		bool restore_masses(const Snapshot& snapshot, std::vector<primatives::Mass>& masses, std::vector<primatives::Spring>& springs);
+	} // namespace checkpoint
+} // namespace simulation
@@ -0,0 +1,272 @@
+#include "frame_capture.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+//stb's own context struct is zero-initialized from fewer fields than it has
+#ifdef __GNUC__
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmissing-field-initializers"
+#endif
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <glfw/deps/stb_image_write.h>
+#ifdef __GNUC__
+#pragma GCC diagnostic pop
+#endif
+
+namespace capture {
+	RenderTarget::~RenderTarget() {
+		if (framebuffer) {
+			glDeleteFramebuffers(1, &framebuffer);
+			glDeleteRenderbuffers(1, &colour);
+			glDeleteRenderbuffers(1, &depth);
+		}
+	}
+
+	bool RenderTarget::bind(int target_width, int target_height) {
+		if (!framebuffer) {
+			glGenFramebuffers(1, &framebuffer);
+			glGenRenderbuffers(1, &colour);
+			glGenRenderbuffers(1, &depth);
+		}
+		glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+		if (target_width != width || target_height != height) {
+			width = target_width;
+			height = target_height;
+			glBindRenderbuffer(GL_RENDERBUFFER, colour);
+			glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+			glBindRenderbuffer(GL_RENDERBUFFER, depth);
+			glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+			glBindRenderbuffer(GL_RENDERBUFFER, 0);
+			glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colour);
+			glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depth);
+		}
+		glViewport(0, 0, width, height);
+		return glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+	}
+
+	void RenderTarget::unbind() {
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	}
+
+	FrameCapture::~FrameCapture() {
+		stop();
+	}
+
+	void FrameCapture::start(const std::string& path_prefix, const Settings& settings) {
+		stop();
+		prefix = path_prefix;
+		format = settings.format;
+		wait_for_buffers = settings.wait_for_buffers;
+		next_frame = 0;
+		written = 0;
+		dropped = 0;
+		write_failed = false;
+
+		//The buffers are sized by the first frame read into them
+		pixel_buffers.resize(std::max<std::size_t>(settings.pixel_buffers, 1));
+		for (PixelBuffer& pixels : pixel_buffers) {
+			pixels = PixelBuffer();
+			glGenBuffers(1, &pixels.buffer);
+		}
+		oldest = 0;
+		in_flight = 0;
+
+		std::size_t worker_count = std::max<std::size_t>(settings.workers, 1);
+		std::size_t image_count = std::max(settings.image_buffers, worker_count);
+		images.resize(image_count);
+		free_images.clear();
+		pending.clear();
+		free_images.reserve(image_count);
+		pending.reserve(image_count);
+		for (std::size_t n = 0; n < image_count; n++) {
+			free_images.push_back(n);
+		}
+		stopping = false;
+		for (std::size_t n = 0; n < worker_count; n++) {
+			workers.emplace_back([this] { run(); });
+		}
+	}
+
+	void FrameCapture::stop() {
+		if (workers.empty()) {
+			return;
+		}
+		collect(true);
+		for (PixelBuffer& pixels : pixel_buffers) {
+			if (pixels.fence) {
+				glDeleteSync(pixels.fence);
+			}
+			glDeleteBuffers(1, &pixels.buffer);
+		}
+		pixel_buffers.clear();
+		in_flight = 0;
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+		work.notify_all();
+		for (std::thread& worker : workers) {
+			worker.join();
+		}
+		workers.clear();
+	}
+
+	void FrameCapture::capture() {
+		if (workers.empty()) {
+			return;
+		}
+		collect(false);
+		if (in_flight == pixel_buffers.size() && wait_for_buffers) {
+			collect(true);
+		}
+		if (in_flight == pixel_buffers.size()) {
+			dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		GLint viewport[4];
+		glGetIntegerv(GL_VIEWPORT, viewport);
+		PixelBuffer& pixels = pixel_buffers[(oldest + in_flight) % pixel_buffers.size()];
+		pixels.width = viewport[2];
+		pixels.height = viewport[3];
+		pixels.frame = next_frame++;
+		std::size_t size = std::size_t(pixels.width) * pixels.height * 3;
+
+		GLint previous_alignment;
+		glGetIntegerv(GL_PACK_ALIGNMENT, &previous_alignment);
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, pixels.buffer);
+		if (size > pixels.capacity) {
+			glBufferData(GL_PIXEL_PACK_BUFFER, size, nullptr, GL_STREAM_READ);
+			pixels.capacity = size;
+		}
+		//Into the bound buffer, so this returns without waiting for the frame
+		glReadPixels(viewport[0], viewport[1], pixels.width, pixels.height, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		glPixelStorei(GL_PACK_ALIGNMENT, previous_alignment);
+		pixels.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		in_flight++;
+	}
+
+	void FrameCapture::collect(bool wait) {
+		while (in_flight > 0) {
+			PixelBuffer& pixels = pixel_buffers[oldest];
+			GLuint64 timeout = wait ? GLuint64(1000000000) : 0;
+			GLenum status = glClientWaitSync(pixels.fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+			if (status == GL_TIMEOUT_EXPIRED) {
+				//Not read back yet
+				if (wait) {
+					continue;
+				}
+				return;
+			}
+
+			std::size_t n = 0;
+			bool have_image = status != GL_WAIT_FAILED;
+			if (have_image) {
+				std::lock_guard<std::mutex> lock(mutex);
+				have_image = !free_images.empty();
+				if (have_image) {
+					n = free_images.back();
+					free_images.pop_back();
+				}
+				else if (!wait) {
+					//Left in the pixel buffer until a worker frees an image
+					return;
+				}
+			}
+			if (status != GL_WAIT_FAILED && !have_image) {
+				std::this_thread::yield();
+				continue;
+			}
+
+			bool mapped = false;
+			if (have_image) {
+				Image& image = images[n];
+				image.frame = pixels.frame;
+				image.width = pixels.width;
+				image.height = pixels.height;
+				std::size_t size = std::size_t(image.width) * image.height * 3;
+				image.pixels.resize(size);
+				glBindBuffer(GL_PIXEL_PACK_BUFFER, pixels.buffer);
+				const void* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+				if (data) {
+					std::memcpy(image.pixels.data(), data, size);
+					mapped = glUnmapBuffer(GL_PIXEL_PACK_BUFFER) == GL_TRUE;
+				}
+				glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+			}
+			glDeleteSync(pixels.fence);
+			pixels.fence = nullptr;
+			oldest = (oldest + 1) % pixel_buffers.size();
+			in_flight--;
+
+			if (!mapped) {
+				dropped.fetch_add(1, std::memory_order_relaxed);
+				if (have_image) {
+					std::lock_guard<std::mutex> lock(mutex);
+					free_images.push_back(n);
+				}
+				continue;
+			}
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				pending.push_back(n);
+			}
+			work.notify_one();
+		}
+	}
+
+	void FrameCapture::run() {
+		//Each worker keeps its own row for flipping
+		std::vector<unsigned char> row;
+		std::unique_lock<std::mutex> lock(mutex);
+		while (true) {
+			work.wait(lock, [this] { return stopping || !pending.empty(); });
+			if (pending.empty()) {
+				return;
+			}
+			std::size_t n = pending.front();
+			pending.erase(pending.begin());
+			lock.unlock();
+
+			if (write(images[n], row)) {
+				written.fetch_add(1, std::memory_order_relaxed);
+			} else {
+				write_failed = true;
+			}
+
+			lock.lock();
+			free_images.push_back(n);
+		}
+	}
+
+	bool FrameCapture::write(Image& image, std::vector<unsigned char>& row) const {
+		//GL reads bottom up, images are stored top down
+		std::size_t stride = std::size_t(image.width) * 3;
+		row.resize(stride);
+		for (int y = 0; y < image.height / 2; y++) {
+			unsigned char* top = image.pixels.data() + y * stride;
+			unsigned char* bottom = image.pixels.data() + (image.height - 1 - y) * stride;
+			std::memcpy(row.data(), top, stride);
+			std::memcpy(top, bottom, stride);
+			std::memcpy(bottom, row.data(), stride);
+		}
+
+		char name[64];
+		if (format == Format::PNG) {
+			std::snprintf(name, sizeof(name), "_%06llu.png", (unsigned long long)image.frame);
+			return stbi_write_png((prefix + name).c_str(), image.width, image.height, 3, image.pixels.data(), int(stride)) != 0;
+		}
+		std::snprintf(name, sizeof(name), "_%06llu_%dx%d.rgb", (unsigned long long)image.frame, image.width, image.height);
+		std::FILE* file = std::fopen((prefix + name).c_str(), "wb");
+		if (!file) {
+			return false;
+		}
+		bool raw_written = std::fwrite(image.pixels.data(), 1, image.pixels.size(), file) == image.pixels.size();
+		return (std::fclose(file) == 0) && raw_written;
+	}
+} // namespace capture
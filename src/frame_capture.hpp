@@ -0,0 +1,127 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <givr.h>
+
+//Saves rendered frames as images, prefix_000000.png and so on. The pixels are read back
+//asynchronously into a ring of pixel-pack buffers and encoded on worker threads.
+namespace capture {
+	enum class Format {
+		PNG,
+		//RGB bytes, bottom row last, named with the size: prefix_000000_640x480.rgb
+		Raw
+	};
+
+	struct Settings {
+		Format format = Format::PNG;
+		//Readbacks in flight on the GPU
+		std::size_t pixel_buffers = 3;
+		//Frames read back but not yet written
+		std::size_t image_buffers = 8;
+		std::size_t workers = 2;
+		//Waits for a free pixel buffer and image instead of dropping the frame, for captures
+		//where every frame has to be saved
+		bool wait_for_buffers = false;
+	};
+
+	//A framebuffer with its own colour and depth storage, for frames that are captured without
+	//being shown: the pixels of a hidden window's framebuffer are undefined
+	class RenderTarget {
+	public:
+		RenderTarget() = default;
+		~RenderTarget();
+
+		RenderTarget(const RenderTarget&) = delete;
+		RenderTarget& operator=(const RenderTarget&) = delete;
+
+		//Draws and reads go to the target, resized to width x height, with the viewport covering
+		//it. False if the GL cannot render to it. Needs the current GL context, as does unbind().
+		bool bind(int width, int height);
+		//Back to the window's framebuffer
+		void unbind();
+
+	private:
+		GLuint framebuffer = 0;
+		GLuint colour = 0;
+		GLuint depth = 0;
+		int width = 0;
+		int height = 0;
+	};
+
+	//Everything on the GL thread only issues commands or checks fences without waiting, so a
+	//capture never stalls the frame. A frame is dropped instead when every pixel buffer is still
+	//being read back or every image is still being written, unless the settings ask to wait.
+	class FrameCapture {
+	public:
+		FrameCapture() = default;
+		~FrameCapture();
+
+		FrameCapture(const FrameCapture&) = delete;
+		FrameCapture& operator=(const FrameCapture&) = delete;
+
+		//Needs the current GL context, as do stop() and capture()
+		void start(const std::string& prefix, const Settings& settings = Settings());
+		//Waits for the readbacks in flight and the images being written
+		void stop();
+		bool capturing() const { return !workers.empty(); }
+
+		//Reads back the current viewport of the read framebuffer, and passes any finished
+		//readbacks on to the workers
+		void capture();
+
+		std::uint64_t frames_written() const { return written.load(std::memory_order_relaxed); }
+		std::uint64_t frames_dropped() const { return dropped.load(std::memory_order_relaxed); }
+		//Set by a worker if an image could not be written
+		bool failed() const { return write_failed.load(std::memory_order_relaxed); }
+
+	private:
+		struct PixelBuffer {
+			GLuint buffer = 0;
+			std::size_t capacity = 0;
+			//Set while a readback is in flight
+			GLsync fence = nullptr;
+			std::uint64_t frame = 0;
+			int width = 0;
+			int height = 0;
+		};
+
+		struct Image {
+			std::uint64_t frame = 0;
+			int width = 0;
+			int height = 0;
+			std::vector<unsigned char> pixels;
+		};
+
+		//Hands the finished readbacks, oldest first, to the workers. With wait it waits for them.
+		void collect(bool wait);
+		void run();
+		bool write(Image& image, std::vector<unsigned char>& row) const;
+
+		std::string prefix;
+		Format format = Format::PNG;
+		bool wait_for_buffers = false;
+		std::vector<PixelBuffer> pixel_buffers;
+		//Oldest readback in flight, and the number in flight
+		std::size_t oldest = 0;
+		std::size_t in_flight = 0;
+		std::uint64_t next_frame = 0;
+
+		std::vector<Image> images;
+		std::vector<std::size_t> free_images;
+		std::vector<std::size_t> pending;
+		std::mutex mutex;
+		std::condition_variable work;
+		bool stopping = false;
+		std::vector<std::thread> workers;
+		std::atomic<std::uint64_t> written{ 0 };
+		std::atomic<std::uint64_t> dropped{ 0 };
+		std::atomic<bool> write_failed{ false };
+	};
+} // namespace capture
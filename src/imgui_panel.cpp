@@ -1,4 +1,5 @@
 #include "imgui_panel.hpp"
+#include "profiler.hpp"
 
 namespace imgui_panel {
 	// default values
@@ -15,12 +16,185 @@ namespace imgui_panel {
 		, {ModelType::CubeOfJelly,   "Cube Of Jelly"}
 		, {ModelType::HangingCloth,  "Hanging Cloth"}
 	};
+	std::vector<std::string> scene_names;
+	int selected_scene = -1;
+	int model_budget_mb = 256;
+	int kept_models = 0;
+	float kept_model_mb = 0.f;
+	bool building_model = false;
+	float build_progress = 0.f;
 
 
 	bool play_simulation = false;
 	bool reset_simulation = false;
 	bool step_simulation = false;
 	float dt_simulation = 0.015f;
+	//Step as many fixed dt's as the frame took, instead of a set number per frame
+	bool real_time_simulation = false;
+	//Blend the display between the last two steps when stepping in real time
+	bool interpolate_rendering = true;
+	double simulation_time = 0.0;
+
+	//Checkpoints
+	bool save_checkpoint = false;
+	bool load_checkpoint = false;
+	char checkpoint_path[256] = "simulation.checkpoint";
+
+	//Trajectory recording
+	bool record_trajectory = false;
+	char trajectory_path[256] = "simulation.trajectory";
+	float trajectory_precision = 1e-4f;
+	std::uint64_t trajectory_frames = 0;
+	std::uint64_t trajectory_dropped = 0;
+
+	//Trajectory playback
+	bool open_playback = false;
+	bool close_playback = false;
+	bool seek_playback = false;
+	bool playing_back = false;
+	int playback_frame = 0;
+	int playback_frame_count = 0;
+
+	//Mesh export
+	bool export_meshes = false;
+	bool export_obj = false;
+	char export_prefix[256] = "surface";
+	std::uint64_t meshes_exported = 0;
+
+	//Frame capture
+	bool capture_frames = false;
+	bool capture_raw = false;
+	char capture_prefix[256] = "frame";
+	std::uint64_t frames_captured = 0;
+	std::uint64_t frames_capture_dropped = 0;
+
+	//Profiling
+	bool record_trace = false;
+	char trace_path[256] = "simulation_trace.json";
+
+	//Plots a value of the completed frames, oldest on the left
+	template <typename Value>
+	static void plot_history(const char* label, Value value) {
+		float (*getter)(void*, int) = [](void* data, int i) {
+			std::size_t frames = givr::stats::historySize();
+			return (*static_cast<Value*>(data))(givr::stats::history(frames - 1 - i));
+		};
+		ImGui::PlotLines(label, getter, &value, int(givr::stats::historySize()), 0, nullptr, 0.f, FLT_MAX, ImVec2(0, 40));
+	}
+
+	static void draw_render_stats() {
+		bool gpu_timing = givr::stats::gpuTimingEnabled();
+		if (ImGui::Checkbox("GPU Timing", &gpu_timing)) {
+			givr::stats::setGpuTimingEnabled(gpu_timing);
+		}
+		if (givr::stats::historySize() == 0) {
+			return;
+		}
+
+		const givr::stats::FrameStats& last = givr::stats::history(0);
+		ImGui::Text("%u draws, %llu vertices, %llu instances", last.draws,
+			(unsigned long long)last.vertices, (unsigned long long)last.instances);
+		ImGui::Text("%u uploads, %.1f KiB", last.uploads, last.bytesUploaded / 1024.0);
+		plot_history("Draws", [](const givr::stats::FrameStats& f) { return float(f.draws); });
+		plot_history("KiB Uploaded", [](const givr::stats::FrameStats& f) { return f.bytesUploaded / 1024.f; });
+
+		if (gpu_timing) {
+			//The GPU times arrive a few frames late, show the newest known
+			for (std::size_t i = 0; i < givr::stats::historySize(); i++) {
+				const givr::stats::FrameStats& f = givr::stats::history(i);
+				if (f.gpuTimeValid) {
+					ImGui::Text("GPU draw %.3f ms, upload %.3f ms", f.gpuDrawMs, f.gpuUploadMs);
+					break;
+				}
+			}
+			plot_history("GPU Draw ms", [](const givr::stats::FrameStats& f) { return float(f.gpuDrawMs); });
+			plot_history("GPU Upload ms", [](const givr::stats::FrameStats& f) { return float(f.gpuUploadMs); });
+		}
+	}
+
+#ifdef SIMULATION_PROFILER
+	static ImU32 phase_colour(profiler::Phase phase) {
+		float hue = float(phase) / float(profiler::phase_count);
+		return ImColor::HSV(hue, 0.6f, 0.9f);
+	}
+#endif
+
+	//Time per phase for each frame, stacked, with the newest frame on the right
+	static void draw_profiler() {
+#ifndef SIMULATION_PROFILER
+		ImGui::TextDisabled("Built without the profiler (ENABLE_PROFILER)");
+#else
+		std::size_t frames = profiler::history_size();
+		if (frames == 0) {
+			return;
+		}
+
+		float scale_ms = 0.f;
+		for (std::size_t i = 0; i < frames; i++) {
+			float total = 0.f;
+			for (std::size_t p = 0; p < profiler::phase_count; p++) {
+				total += profiler::frame_ms(profiler::Phase(p), i);
+			}
+			scale_ms = std::max(scale_ms, total);
+		}
+
+		ImVec2 size(ImGui::GetContentRegionAvail().x, 80.f);
+		ImVec2 origin = ImGui::GetCursorScreenPos();
+		ImDrawList* draw_list = ImGui::GetWindowDrawList();
+		draw_list->AddRectFilled(origin, ImVec2(origin.x + size.x, origin.y + size.y), ImGui::GetColorU32(ImGuiCol_FrameBg));
+		float bar = size.x / float(profiler::history_length);
+		for (std::size_t i = 0; i < frames && scale_ms > 0.f; i++) {
+			float x = origin.x + size.x - (i + 1) * bar;
+			float y = origin.y + size.y;
+			for (std::size_t p = 0; p < profiler::phase_count; p++) {
+				float h = profiler::frame_ms(profiler::Phase(p), i) / scale_ms * size.y;
+				draw_list->AddRectFilled(ImVec2(x, y - h), ImVec2(x + bar, y), phase_colour(profiler::Phase(p)));
+				y -= h;
+			}
+		}
+		ImGui::Dummy(size);
+		ImGui::Text("Peak %.3f ms", scale_ms);
+
+		//Heap allocations per frame are shown when the allocation tracking is built in
+		if (ImGui::BeginTable("Phases", allocation::tracking ? 5 : 4)) {
+			ImGui::TableSetupColumn("Phase");
+			ImGui::TableSetupColumn("Min ms");
+			ImGui::TableSetupColumn("Avg ms");
+			ImGui::TableSetupColumn("p99 ms");
+			if (allocation::tracking) {
+				ImGui::TableSetupColumn("Max allocs");
+			}
+			ImGui::TableHeadersRow();
+			for (std::size_t p = 0; p < profiler::phase_count; p++) {
+				profiler::Phase phase = profiler::Phase(p);
+				profiler::Summary summary = profiler::summarize(phase);
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				ImGui::TextColored(ImColor(phase_colour(phase)), "%s", profiler::phase_name(phase));
+				ImGui::TableNextColumn();
+				ImGui::Text("%.3f", summary.min_ms);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.3f", summary.avg_ms);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.3f", summary.p99_ms);
+				if (allocation::tracking) {
+					ImGui::TableNextColumn();
+					ImGui::Text("%u", summary.max_allocations);
+				}
+			}
+			ImGui::EndTable();
+		}
+		if (profiler::dropped_samples() > 0) {
+			ImGui::Text("%llu samples dropped", (unsigned long long)profiler::dropped_samples());
+		}
+
+		//Chrome trace-event JSON, opens in about://tracing or ui.perfetto.dev
+		if (!record_trace) {
+			ImGui::InputText("Trace File", trace_path, sizeof(trace_path));
+		}
+		ImGui::Checkbox("Record Trace", &record_trace);
+#endif
+	}
 
 	std::function<void(void)> draw = [](void) {
 		if (showPanel && ImGui::Begin("Panel", &showPanel, ImGuiWindowFlags_MenuBar)) {
@@ -34,16 +208,35 @@ namespace imgui_panel {
 			ImGui::Spacing();
 			ImGui::Separator();
 
-			if (ImGui::BeginCombo("Model", type_to_name_map[selected_model_type])){
+			const char* selected_name = selected_scene < 0 ? type_to_name_map[selected_model_type] : scene_names[selected_scene].c_str();
+			if (ImGui::BeginCombo("Model", selected_name)){
 				for (const std::pair<ModelType, const char*> entry_pair : type_to_name_map){
-					bool is_selected = (entry_pair.first == selected_model_type);
-					if (ImGui::Selectable(entry_pair.second, is_selected))
+					bool is_selected = (selected_scene < 0 && entry_pair.first == selected_model_type);
+					if (ImGui::Selectable(entry_pair.second, is_selected)) {
 						selected_model_type = entry_pair.first;
+						selected_scene = -1;
+					}
+					if (is_selected)
+						ImGui::SetItemDefaultFocus();
+				}
+				if (!scene_names.empty())
+					ImGui::Separator();
+				for (int n = 0; n < int(scene_names.size()); n++){
+					bool is_selected = (n == selected_scene);
+					ImGui::PushID(n);
+					if (ImGui::Selectable(scene_names[n].c_str(), is_selected))
+						selected_scene = n;
+					ImGui::PopID();
 					if (is_selected)
 						ImGui::SetItemDefaultFocus();
 				}
 				ImGui::EndCombo();
 			}
+			if (building_model) {
+				ImGui::ProgressBar(build_progress, ImVec2(-1.f, 0.f), "Building model");
+			}
+			ImGui::SliderInt("Kept Models Budget (MB)", &model_budget_mb, 16, 4096);
+			ImGui::Text("%d models kept, %.1f MB", kept_models, kept_model_mb);
 
 			ImGui::Checkbox("Play Simulation", &play_simulation);
 			reset_simulation = ImGui::Button("Reset Simulation");
@@ -51,6 +244,68 @@ namespace imgui_panel {
 				step_simulation = ImGui::Button("Step Simulation");
 			}
 			ImGui::DragFloat("Simulation dt", &dt_simulation, 1.e-5f, 1.e-5f, 1.f, "%.6e");
+			ImGui::Checkbox("Real Time Stepping", &real_time_simulation);
+			if (real_time_simulation) {
+				ImGui::Checkbox("Interpolate Rendering", &interpolate_rendering);
+			}
+			ImGui::Text("Simulated time %.4f s", simulation_time);
+
+			save_checkpoint = false;
+			load_checkpoint = false;
+			open_playback = false;
+			close_playback = false;
+			seek_playback = false;
+			if (ImGui::CollapsingHeader("Checkpoint")) {
+				ImGui::InputText("Checkpoint File", checkpoint_path, sizeof(checkpoint_path));
+				save_checkpoint = ImGui::Button("Save");
+				ImGui::SameLine();
+				load_checkpoint = ImGui::Button("Load");
+			}
+			if (ImGui::CollapsingHeader("Trajectory")) {
+				//Settings are fixed for a recording
+				if (!record_trajectory) {
+					ImGui::InputText("Trajectory File", trajectory_path, sizeof(trajectory_path));
+					ImGui::DragFloat("Precision", &trajectory_precision, 1.e-6f, 1.e-6f, 1.f, "%.1e");
+				}
+				if (!playing_back) {
+					ImGui::Checkbox("Record Trajectory", &record_trajectory);
+					ImGui::Text("%llu frames recorded, %llu dropped", (unsigned long long)trajectory_frames, (unsigned long long)trajectory_dropped);
+				}
+				if (!record_trajectory) {
+					open_playback = ImGui::Button("Play Back");
+				}
+				if (playing_back) {
+					ImGui::SameLine();
+					close_playback = ImGui::Button("Close");
+					seek_playback = ImGui::SliderInt("Frame", &playback_frame, 0, std::max(playback_frame_count - 1, 0));
+				}
+			}
+			if (ImGui::CollapsingHeader("Mesh Export")) {
+				//A file per frame of the surface (the cloth or the jelly), named prefix_000000.ply
+				if (!export_meshes) {
+					ImGui::InputText("File Prefix", export_prefix, sizeof(export_prefix));
+					int obj = export_obj ? 1 : 0;
+					ImGui::RadioButton("PLY", &obj, 0);
+					ImGui::SameLine();
+					ImGui::RadioButton("OBJ", &obj, 1);
+					export_obj = obj == 1;
+				}
+				ImGui::Checkbox("Export Meshes", &export_meshes);
+				ImGui::Text("%llu meshes written", (unsigned long long)meshes_exported);
+			}
+			if (ImGui::CollapsingHeader("Frame Capture")) {
+				//The rendered scene without the panel, named prefix_000000.png
+				if (!capture_frames) {
+					ImGui::InputText("Image Prefix", capture_prefix, sizeof(capture_prefix));
+					int raw = capture_raw ? 1 : 0;
+					ImGui::RadioButton("PNG", &raw, 0);
+					ImGui::SameLine();
+					ImGui::RadioButton("Raw RGB", &raw, 1);
+					capture_raw = raw == 1;
+				}
+				ImGui::Checkbox("Capture Frames", &capture_frames);
+				ImGui::Text("%llu frames written, %llu dropped", (unsigned long long)frames_captured, (unsigned long long)frames_capture_dropped);
+			}
 
 			ImGui::Spacing();
 			ImGui::Separator();
@@ -75,6 +330,13 @@ namespace imgui_panel {
 			ImGui::Text("Application average %.3f ms/frame (%.1f FPS)",
 				1000.0f / frame_rate, frame_rate);
 
+			if (ImGui::CollapsingHeader("Render Stats")) {
+				draw_render_stats();
+			}
+			if (ImGui::CollapsingHeader("Profiler")) {
+				draw_profiler();
+			}
+
 			ImGui::Spacing();
 			ImGui::Separator();
 
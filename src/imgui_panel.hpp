@@ -3,6 +3,10 @@
 #include <givio.h>
 #include <givr.h>
 #include <imgui/imgui.h>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
 
 namespace imgui_panel {
 	extern bool showPanel;
@@ -18,12 +22,67 @@ namespace imgui_panel {
 		HangingCloth	//Part 4
 	};
 
+	extern std::map<ModelType, const char*> type_to_name_map;
+
 	//Simulation settings
 	extern ModelType selected_model_type;
+	//Scenes loaded from the scenes directory, listed after the models. -1 is the selected
+	//model type with its built in parameters.
+	extern std::vector<std::string> scene_names;
+	extern int selected_scene;
+	//Estimated size the models switched away from are kept up to
+	extern int model_budget_mb;
+	//Set by main
+	extern int kept_models;
+	extern float kept_model_mb;
+	//Set by main while the picked model is built in the background
+	extern bool building_model;
+	extern float build_progress;
 	extern bool play_simulation;
 	extern bool reset_simulation;
 	extern bool step_simulation;
 	extern float dt_simulation;
+	extern bool real_time_simulation;
+	extern bool interpolate_rendering;
+	//Simulated time of the current model, set by main
+	extern double simulation_time;
+
+	//Checkpoints
+	extern bool save_checkpoint;
+	extern bool load_checkpoint;
+	extern char checkpoint_path[256];
+
+	//Trajectory recording, the counts are set by main
+	extern bool record_trajectory;
+	extern char trajectory_path[256];
+	extern float trajectory_precision;
+	extern std::uint64_t trajectory_frames;
+	extern std::uint64_t trajectory_dropped;
+
+	//Trajectory playback, playing_back and the frames are set by main
+	extern bool open_playback;
+	extern bool close_playback;
+	extern bool seek_playback;
+	extern bool playing_back;
+	extern int playback_frame;
+	extern int playback_frame_count;
+
+	//Mesh export of the model's surface, the count is set by main
+	extern bool export_meshes;
+	extern bool export_obj;
+	extern char export_prefix[256];
+	extern std::uint64_t meshes_exported;
+
+	//Frame capture, the counts are set by main
+	extern bool capture_frames;
+	extern bool capture_raw;
+	extern char capture_prefix[256];
+	extern std::uint64_t frames_captured;
+	extern std::uint64_t frames_capture_dropped;
+
+	//Profiling
+	extern bool record_trace;
+	extern char trace_path[256];
 
 	// lambda function
 	extern std::function<void(void)> draw;
@@ -0,0 +1,168 @@
+#include "json_reader.hpp"
+
+#include <cstdlib>
+
+namespace json {
+	Reader::Reader(std::FILE* file) : file(file) {}
+
+	void Reader::fail(const std::string& message) {
+		if (ok()) {
+			failed_message = "line " + std::to_string(line) + ": " + message;
+		}
+	}
+
+	int Reader::peek() {
+		if (position == buffered) {
+			buffered = file ? std::fread(buffer, 1, sizeof(buffer), file) : 0;
+			position = 0;
+			if (buffered == 0) {
+				return EOF;
+			}
+		}
+		return (unsigned char)buffer[position];
+	}
+
+	int Reader::get() {
+		int c = peek();
+		if (c != EOF) {
+			position++;
+			if (c == '\n') {
+				line++;
+			}
+		}
+		return c;
+	}
+
+	void Reader::skip_whitespace() {
+		while (true) {
+			int c = peek();
+			if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+				return;
+			}
+			get();
+		}
+	}
+
+	bool Reader::expect(char c) {
+		skip_whitespace();
+		if (peek() != c) {
+			fail(std::string("expected '") + c + "'");
+			return false;
+		}
+		get();
+		return true;
+	}
+
+	bool Reader::separator(char close, bool& closed) {
+		closed = false;
+		if (!ok() || started.empty()) {
+			return false;
+		}
+		skip_whitespace();
+		if (peek() == close) {
+			get();
+			started.pop_back();
+			closed = true;
+			return true;
+		}
+		if (started.back() && !expect(',')) {
+			return false;
+		}
+		started.back() = true;
+		return true;
+	}
+
+	bool Reader::begin_object() {
+		if (!ok() || !expect('{')) {
+			return false;
+		}
+		started.push_back(false);
+		return true;
+	}
+
+	bool Reader::next_key(std::string& key) {
+		bool closed;
+		if (!separator('}', closed) || closed) {
+			return false;
+		}
+		return read_string(key) && expect(':');
+	}
+
+	bool Reader::begin_array() {
+		if (!ok() || !expect('[')) {
+			return false;
+		}
+		started.push_back(false);
+		return true;
+	}
+
+	bool Reader::next_element() {
+		bool closed;
+		return separator(']', closed) && !closed;
+	}
+
+	bool Reader::read_number(double& value) {
+		if (!ok()) {
+			return false;
+		}
+		skip_whitespace();
+		char text[64];
+		std::size_t length = 0;
+		while (length + 1 < sizeof(text)) {
+			int c = peek();
+			if ((c < '0' || c > '9') && c != '-' && c != '+' && c != '.' && c != 'e' && c != 'E') {
+				break;
+			}
+			text[length++] = char(get());
+		}
+		text[length] = '\0';
+		char* parsed;
+		value = std::strtod(text, &parsed);
+		if (length == 0 || parsed != text + length) {
+			fail("expected a number");
+			return false;
+		}
+		return true;
+	}
+
+	bool Reader::read_string(std::string& value) {
+		if (!ok() || !expect('"')) {
+			return false;
+		}
+		value.clear();
+		while (true) {
+			int c = get();
+			if (c == EOF || c == '\n') {
+				fail("unterminated string");
+				return false;
+			}
+			if (c == '"') {
+				return true;
+			}
+			if (c == '\\') {
+				c = get();
+				switch (c) {
+				case 'n': c = '\n'; break;
+				case 't': c = '\t'; break;
+				case 'r': c = '\r'; break;
+				case 'b': c = '\b'; break;
+				case 'f': c = '\f'; break;
+				case '"': case '\\': case '/': break;
+				default:
+					//Names and paths do not need \u escapes
+					fail("unsupported escape in string");
+					return false;
+				}
+			}
+			value.push_back(char(c));
+		}
+	}
+
+	bool Reader::end() {
+		skip_whitespace();
+		if (ok() && peek() != EOF) {
+			fail("unexpected text after the end");
+		}
+		return ok();
+	}
+} // namespace json
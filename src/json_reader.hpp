@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+//A small pull parser for JSON, read a buffer at a time from a file. Nothing is built up: the
+//caller walks the document, asking for the value it expects next. The first mismatch or syntax
+//error stops the reader, and every later call fails.
+namespace json {
+	class Reader {
+	public:
+		explicit Reader(std::FILE* file);
+
+		bool ok() const { return failed_message.empty(); }
+		//What failed and on which line
+		const std::string& error() const { return failed_message; }
+		void fail(const std::string& message);
+
+		bool begin_object();
+		//Reads the next key of the object, false once the object is closed
+		bool next_key(std::string& key);
+		bool begin_array();
+		//True if another element follows, false once the array is closed
+		bool next_element();
+
+		bool read_number(double& value);
+		bool read_string(std::string& value);
+		//After the outermost value, only whitespace is left
+		bool end();
+
+	private:
+		int peek();
+		int get();
+		void skip_whitespace();
+		bool expect(char c);
+		//Before each key or element after the first
+		bool separator(char close, bool& closed);
+
+		std::FILE* file;
+		char buffer[4096];
+		std::size_t buffered = 0;
+		std::size_t position = 0;
+		int line = 1;
+		//Whether each open container has had a member yet
+		std::vector<bool> started;
+		std::string failed_message;
+	};
+} // namespace json
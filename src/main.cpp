@@ -12,7 +12,18 @@
 
 #include "models.hpp"
 #include "imgui_panel.hpp"
+#include "profiler.hpp"
+#include "benchmark.hpp"
+#include "checkpoint.hpp"
+#include "trajectory.hpp"
+#include "playback.hpp"
+#include "mesh_exporter.hpp"
+#include "frame_capture.hpp"
+#include "scene.hpp"
+#include "model_pool.hpp"
 #include <iostream>
+#include <cstring>
+#include <algorithm>
 
 using namespace giv;
 using namespace giv::io;
@@ -21,8 +32,26 @@ using namespace givr::camera;
 using namespace givr::geometry;
 using namespace givr::style;
 
+// Makes a model with its built in parameters and sets the dt it runs well at
+static std::unique_ptr<simulation::models::GenericModel> create_model(imgui_panel::ModelType model_type) {
+	simulation::scene::Scene scene;
+	scene.type = model_type;
+	imgui_panel::dt_simulation = simulation::scene::default_dt(model_type); //Good idea to hard-code a good dt for each simulation
+	std::unique_ptr<simulation::models::GenericModel> model = simulation::scene::build(scene);
+	model->create_renderables();
+	return model;
+}
+
+// Steps every model in a hidden window and prints the timings: --benchmark [steps]
+static int benchmark_main(GLFWContext& glContext, std::size_t steps) {
+	Window window = glContext.windowVisible(false).makeWindow(Properties()
+		.size(dimensions{ 64, 64 })
+		.title("Mass Spring Systems Benchmark"));
+	return benchmark::run(create_model, steps);
+}
+
 // program entry point
-int main(void) {
+int main(int argc, char** argv) {
 	// initialize OpenGL and window
 	GLFWContext glContext;
 	glContext.glMajorVesion(3)
@@ -33,6 +62,36 @@ int main(void) {
 		.matchPrimaryMonitorVideoMode();
 	std::cout << glfwVersionString() << '\n';
 
+	// [--egl] [--benchmark [steps] | --offscreen [frames]]
+	const char* mode = "";
+	const char* count = nullptr;
+	for (int i = 1; i < argc; i++) {
+		if (std::strcmp(argv[i], "--egl") == 0) {
+			glContext.glEGLContextAPI(true);
+		}
+		else if (!*mode) {
+			mode = argv[i];
+		}
+		else if (!count) {
+			count = argv[i];
+		}
+	}
+
+	if (std::strcmp(mode, "--benchmark") == 0) {
+		std::size_t steps = count ? std::strtoul(count, nullptr, 10) : 10000;
+		return benchmark_main(glContext, std::max<std::size_t>(steps, 1));
+	}
+
+	// Plays the simulation in a hidden window and captures the frames, then exits
+	bool offscreen = std::strcmp(mode, "--offscreen") == 0;
+	std::size_t offscreen_frames = std::max<std::size_t>(count ? std::strtoul(count, nullptr, 10) : 100, 1);
+	if (offscreen) {
+		glContext.windowVisible(false);
+		imgui_panel::showPanel = false;
+		imgui_panel::play_simulation = true;
+		imgui_panel::capture_frames = true;
+	}
+
 	// setup window (OpenGL context)
 	ImGuiWindow window = glContext.makeImGuiWindow(Properties()
 		.size(dimensions{ 1000, 1000 })
@@ -56,66 +115,402 @@ int main(void) {
 		| Key(GLFW_KEY_V, reset_view_routine)
 		| Key(GLFW_KEY_ESCAPE, close_window_routine);
 
-	// Models
+	// Scenes are only parsed here, each model is built when it is picked
+	std::vector<std::string> scene_errors;
+	std::vector<simulation::scene::Scene> scenes = simulation::scene::load_directory("scenes", scene_errors);
+	for (const std::string& error : scene_errors) {
+		std::cerr << "Could not load scene " << error << '\n';
+	}
+	for (const simulation::scene::Scene& scene : scenes) {
+		imgui_panel::scene_names.push_back(scene.name);
+	}
+
+	// Models are kept by scene index, or by -1 - their type for the built in parameters
+	simulation::models::ModelPool pool(std::size_t(imgui_panel::model_budget_mb) << 20);
+	auto pool_key = [](imgui_panel::ModelType type, int scene) { return scene >= 0 ? scene : -1 - int(type); };
+	auto scene_of = [&](int key) {
+		if (key >= 0) {
+			return scenes[key];
+		}
+		simulation::scene::Scene scene;
+		scene.type = imgui_panel::ModelType(-1 - key);
+		return scene;
+	};
+	// What a newly built model runs with
+	auto scene_settings = [](const simulation::scene::Scene& scene) {
+		simulation::models::ModelPool::Settings settings;
+		settings.dt = scene.dt > 0.f ? scene.dt : simulation::scene::default_dt(scene.type);
+		settings.iterations_per_frame = scene.iterations_per_frame > 0 ? scene.iterations_per_frame : imgui_panel::number_of_iterations_per_frame;
+		return settings;
+	};
+	auto current_settings = []() {
+		simulation::models::ModelPool::Settings settings;
+		settings.dt = imgui_panel::dt_simulation;
+		settings.iterations_per_frame = imgui_panel::number_of_iterations_per_frame;
+		return settings;
+	};
+	// The key's model, kept or newly built (here, so only for small or kept models), with its
+	// settings made current
+	auto use_model = [&](int key) {
+		simulation::scene::Scene scene = scene_of(key);
+		simulation::models::ModelPool::Kept kept = pool.acquire(key, [&]() {
+			std::unique_ptr<simulation::models::GenericModel> built = simulation::scene::build(scene);
+			built->create_renderables();
+			return built;
+		}, scene_settings(scene));
+		imgui_panel::dt_simulation = kept.settings.dt;
+		imgui_panel::number_of_iterations_per_frame = kept.settings.iterations_per_frame;
+		return kept.model;
+	};
+
 	imgui_panel::ModelType model_type = imgui_panel::ModelType::MassOnSpring;
-	std::unique_ptr<simulation::models::GenericModel> model
-		= std::make_unique<simulation::models::MassOnSpringModel>();
+	int scene_index = -1;
+	// What the current model was built from, a scene or a model type's built in parameters
+	simulation::scene::Scene current_scene = scene_of(pool_key(model_type, scene_index));
+	simulation::models::GenericModel* model = use_model(pool_key(model_type, scene_index));
+	// The model picked in the panel. Until it is kept in the pool it is built in the background,
+	// and the current model stays.
+	int target_key = pool_key(model_type, scene_index);
+	simulation::scene::Builder builder;
+	// While the simulation is paused, the other models are built in the background too (each
+	// tried once) so that picking them is instant
+	int prebuild_next = 0;
+	const int prebuild_count = int(imgui_panel::type_to_name_map.size() + scenes.size());
+
+	// Simulated time owed to the real time stepping, always less than one step
+	float accumulator = 0.f;
+	// Longest frame the real time stepping catches up on, so a stall does not snowball
+	const float max_frame_time = 0.1f;
+
+	// Set while the model is a trajectory being played back, which is not kept once closed
+	std::unique_ptr<simulation::models::PlaybackModel> playback;
+	// Switching away from a kept model, so it comes back with the dt and iterations it was left with
+	auto keep_current = [&]() {
+		if (!playback) {
+			pool.keep_settings(pool_key(model_type, scene_index), current_settings());
+		}
+	};
+
+	// Record a frame after each frame the simulation advanced
+	simulation::trajectory::Recorder recorder;
+	simulation::mesh_export::Exporter exporter;
+	capture::FrameCapture frame_capture;
+	capture::RenderTarget render_target;
+	// Recordings and exports are of one model, they end when the model is replaced
+	auto stop_recording = [&]() {
+		recorder.stop();
+		exporter.stop();
+		imgui_panel::record_trajectory = false;
+		imgui_panel::export_meshes = false;
+	};
+
+	// Makes a kept model current
+	auto switch_to = [&](int key) {
+		keep_current();
+		scene_index = key >= 0 ? key : -1;
+		current_scene = scene_of(key);
+		model_type = imgui_panel::selected_model_type = current_scene.type;
+		imgui_panel::selected_scene = scene_index;
+		target_key = key;
+		imgui_panel::play_simulation = false; //For safety reasons, stop simulation
+		accumulator = 0.f;
+		stop_recording();
+		model = use_model(key);
+		playback.reset();
+	};
 
 	// main loop
-	mainloop(std::move(window), [&](float /*dt - Time since last frame. You should start by using imgui_panel::dt and only use this under the "Free the Physics" time step scheme */) {
+	mainloop(std::move(window), [&](float dt /*Time since last frame, only used by the real time ("Free the Physics") stepping */) {
 		// updates from panel
 		if (imgui_panel::reset_view) {
 			view.camera.reset();
 		}
 
-		// Change simulation model
-		if (model_type != imgui_panel::selected_model_type) {
-			model_type = imgui_panel::selected_model_type;
-			imgui_panel::play_simulation = false; //For safety reasons, stop simulation
-			switch (model_type) {
-			case imgui_panel::ModelType::MassOnSpring: {
-				model = std::make_unique<simulation::models::MassOnSpringModel>();
-				imgui_panel::dt_simulation = 0.001f;
-			}break;
-			case imgui_panel::ModelType::ChainPendulum: {
-				model = std::make_unique<simulation::models::ChainPendulumModel>();
-				imgui_panel::dt_simulation = 0.001f; //Good idea to hard-code a good dt for each simulation
-			}break;
-			case imgui_panel::ModelType::CubeOfJelly: {
-				model = std::make_unique<simulation::models::CubeOfJellyModel>();
-				imgui_panel::dt_simulation = 0.0002f;
-			}break;
-			case imgui_panel::ModelType::HangingCloth: {
-				model = std::make_unique<simulation::models::HangingClothModel>();
-				imgui_panel::dt_simulation = 0.0002f;
-			}break;
+		// Change simulation model, straight away if it is kept
+		if (pool_key(imgui_panel::selected_model_type, imgui_panel::selected_scene) != target_key) {
+			target_key = pool_key(imgui_panel::selected_model_type, imgui_panel::selected_scene);
+			if (pool.contains(target_key)) {
+				switch_to(target_key);
+			}
+		}
+
+		// A finished build gets its renderables here, then becomes current if it is still the one
+		// picked, or is kept for later
+		if (builder.building()) {
+			int built_key = builder.key();
+			std::unique_ptr<simulation::models::GenericModel> built = builder.take();
+			if (built && built_key == target_key) {
+				pool.replace(built_key, std::move(built), scene_settings(scene_of(built_key)));
+				switch_to(built_key);
+			}
+			else if (built) {
+				pool.prebuild(built_key, [&]() { return std::move(built); }, scene_settings(scene_of(built_key)));
+			}
+			else if (!builder.building() && builder.failed()) {
+				std::cerr << "Ran out of memory building " << (built_key >= 0 ? scenes[built_key].name : imgui_panel::type_to_name_map[imgui_panel::ModelType(-1 - built_key)]) << '\n';
+				if (built_key == target_key) {
+					imgui_panel::selected_model_type = model_type;
+					imgui_panel::selected_scene = scene_index;
+					target_key = pool_key(model_type, scene_index);
+				}
+			}
+		}
+		if (!builder.building() && target_key != pool_key(model_type, scene_index) && !pool.contains(target_key)) {
+			builder.start(target_key, scene_of(target_key));
+		}
+		while (!builder.building() && !imgui_panel::play_simulation && prebuild_next < prebuild_count) {
+			// The model types, then the scenes
+			int n = prebuild_next++;
+			int key = n < int(imgui_panel::type_to_name_map.size()) ? -1 - n : n - int(imgui_panel::type_to_name_map.size());
+			if (!pool.contains(key) && pool.bytes() < pool.budget()) {
+				builder.start(key, scene_of(key));
+			}
+		}
+		// Waiting on the picked model, possibly behind another model building first
+		imgui_panel::building_model = target_key != pool_key(model_type, scene_index);
+		imgui_panel::build_progress = builder.building() && builder.key() == target_key ? builder.progress() : 0.f;
+
+		// A trajectory replaces the model until it is closed, or another model is picked
+		if (imgui_panel::open_playback) {
+			std::unique_ptr<simulation::models::PlaybackModel> opened = std::make_unique<simulation::models::PlaybackModel>();
+			if (!opened->open(imgui_panel::trajectory_path)) {
+				std::cerr << "Could not play back trajectory: " << opened->error() << '\n';
 			}
+			else {
+				opened->create_renderables();
+				keep_current();
+				stop_recording();
+				imgui_panel::play_simulation = false;
+				imgui_panel::dt_simulation = opened->frame_dt();
+				accumulator = 0.f;
+				playback = std::move(opened);
+				model = playback.get();
+			}
+		}
+		if (imgui_panel::close_playback && playback) {
+			imgui_panel::play_simulation = false;
+			accumulator = 0.f;
+			model = use_model(pool_key(model_type, scene_index));
+			playback.reset();
+		}
+		if (imgui_panel::seek_playback && playback) {
+			playback->seek(std::size_t(std::max(imgui_panel::playback_frame, 0)));
+			playback->save_previous();
+			playback->alpha = 1.f;
 		}
 
 		//Simulation updates
 		if (imgui_panel::reset_simulation) {
+			// A recording carried on past the reset would go back in time
+			stop_recording();
+			// Before the reset, which a playback sets to the time of its first frame
+			model->time = 0.0;
 			model->reset();
 		}
 
+		if (imgui_panel::save_checkpoint && playback) {
+			std::cerr << "A trajectory being played back has no checkpoint to save\n";
+		}
+		else if (imgui_panel::save_checkpoint) {
+			simulation::checkpoint::State state;
+			model->save(state);
+			if (!simulation::checkpoint::write(imgui_panel::checkpoint_path, std::uint32_t(model_type), model->time, imgui_panel::dt_simulation, state)) {
+				std::cerr << "Could not write checkpoint " << imgui_panel::checkpoint_path << '\n';
+			}
+		}
+
+		// A checkpoint replaces the model with a new one of its type, then overwrites its state. The
+		// current scene is kept if it is of that type, otherwise the type's built in parameters are.
+		if (imgui_panel::load_checkpoint) {
+			simulation::checkpoint::Snapshot snapshot;
+			if (!snapshot.open(imgui_panel::checkpoint_path)) {
+				std::cerr << "Could not load checkpoint: " << snapshot.error() << '\n';
+			}
+			else {
+				const simulation::checkpoint::Header& header = snapshot.header();
+				imgui_panel::ModelType loaded_type = imgui_panel::ModelType(header.model_type);
+				// Rebuilt at the size it was saved from, so it loads whichever scene is selected
+				simulation::scene::Scene loaded_scene = loaded_type == current_scene.type ? current_scene : simulation::scene::Scene();
+				std::unique_ptr<simulation::models::GenericModel> loaded;
+				if (imgui_panel::type_to_name_map.count(loaded_type) > 0 && simulation::scene::from_checkpoint(snapshot, loaded_scene)) {
+					loaded = simulation::scene::build(loaded_scene);
+					loaded->create_renderables();
+				}
+				if (!loaded || !loaded->restore(snapshot)) {
+					std::cerr << "Checkpoint " << imgui_panel::checkpoint_path << " does not match its model\n";
+				}
+				else {
+					loaded->time = header.time;
+					keep_current();
+					stop_recording();
+					model_type = imgui_panel::selected_model_type = loaded_type;
+					if (!simulation::scene::same_body(loaded_scene, current_scene)) {
+						scene_index = imgui_panel::selected_scene = -1;
+					}
+					current_scene = loaded_scene;
+					target_key = pool_key(model_type, scene_index);
+					imgui_panel::dt_simulation = header.dt;
+					// Takes the place of the kept model in its slot
+					model = &pool.replace(pool_key(model_type, scene_index), std::move(loaded), current_settings());
+					playback.reset();
+					imgui_panel::play_simulation = false;
+					accumulator = 0.f;
+				}
+			}
+		}
+
+		// Start or stop recording the trajectory from the panel
+		if (imgui_panel::record_trajectory != recorder.recording()) {
+			simulation::trajectory::Settings settings;
+			settings.precision = imgui_panel::trajectory_precision;
+			if (!imgui_panel::record_trajectory) {
+				recorder.stop();
+			}
+			else if (!recorder.start(imgui_panel::trajectory_path, std::uint32_t(model_type), model->mass_count(), imgui_panel::dt_simulation, settings)) {
+				std::cerr << "Could not open trajectory file " << imgui_panel::trajectory_path << '\n';
+				imgui_panel::record_trajectory = false;
+			}
+		}
+
+		// Start or stop exporting the surface meshes from the panel
+		if (imgui_panel::export_meshes != exporter.exporting()) {
+			simulation::mesh_export::Settings settings;
+			settings.format = imgui_panel::export_obj ? simulation::mesh_export::Format::OBJ : simulation::mesh_export::Format::PLY;
+			if (!imgui_panel::export_meshes) {
+				exporter.stop();
+			}
+			else if (!exporter.start(imgui_panel::export_prefix, *model, settings)) {
+				std::cerr << "This model has no surface to export\n";
+				imgui_panel::export_meshes = false;
+			}
+		}
+
+		double time_before = model->time;
+
 		if (imgui_panel::step_simulation) {
-			model->step(imgui_panel::dt_simulation);
+			model->save_previous();
+			model->advance(imgui_panel::dt_simulation);
+			model->alpha = 1.f;
 		}
 
-		if (imgui_panel::play_simulation) {
+		if (imgui_panel::play_simulation && imgui_panel::real_time_simulation) {
+			// Take the whole steps that fit in the elapsed time and carry the remainder. The
+			// state before the last step is kept so the display can be blended between the two.
+			accumulator += std::min(dt, max_frame_time);
+			int steps = int(accumulator / imgui_panel::dt_simulation);
+			accumulator -= steps * imgui_panel::dt_simulation;
+			for (int i = 0; i < steps; i++) {
+				if (i == steps - 1) {
+					model->save_previous();
+				}
+				model->advance(imgui_panel::dt_simulation);
+			}
+			model->alpha = imgui_panel::interpolate_rendering ? accumulator / imgui_panel::dt_simulation : 1.f;
+		}
+		else if (imgui_panel::play_simulation) {
 			for (size_t i = 0; i < imgui_panel::number_of_iterations_per_frame; i++) {
-				model->step(imgui_panel::dt_simulation);
+				model->advance(imgui_panel::dt_simulation);
 			}
+			model->alpha = 1.f;
 		}
 
-		// render
+		if (recorder.recording() && model->time != time_before) {
+			recorder.record(*model);
+		}
+		if (exporter.exporting() && model->time != time_before) {
+			exporter.export_frame(*model);
+		}
+		if (exporter.exporting() && exporter.failed()) {
+			std::cerr << "Could not write a mesh starting with " << imgui_panel::export_prefix << '\n';
+			exporter.stop();
+			imgui_panel::export_meshes = false;
+		}
+		if (recorder.recording() && recorder.failed()) {
+			std::cerr << "Could not write trajectory file " << imgui_panel::trajectory_path << '\n';
+			recorder.stop();
+			imgui_panel::record_trajectory = false;
+		}
+		imgui_panel::trajectory_frames = recorder.frames_written();
+		imgui_panel::trajectory_dropped = recorder.frames_dropped();
+		imgui_panel::meshes_exported = exporter.frames_exported();
+		imgui_panel::simulation_time = model->time;
+		imgui_panel::playing_back = playback != nullptr;
+		if (playback) {
+			imgui_panel::playback_frame = int(playback->frame());
+			imgui_panel::playback_frame_count = int(playback->frame_count());
+		}
+
+		// render, offscreen into a framebuffer of its own since a hidden window's pixels are undefined
+		if (offscreen && !render_target.bind(window.width(), window.height())) {
+			std::cerr << "Could not create the offscreen framebuffer\n";
+			window.shouldClose();
+		}
 		auto color = imgui_panel::clear_color;
 		glClearColor(color.x, color.y, color.z, color.z);
 		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 		view.projection.updateAspectRatio(window.width(), window.height());
 
+		givr::stats::beginFrame();
 		model->render(view);
+		givr::stats::endFrame();
+
+		// Start or stop capturing the frames from the panel, they are read before the panel is drawn
+		if (imgui_panel::capture_frames != frame_capture.capturing()) {
+			capture::Settings settings;
+			settings.format = imgui_panel::capture_raw ? capture::Format::Raw : capture::Format::PNG;
+			// Offscreen, every frame is saved however long the images take to write
+			settings.wait_for_buffers = offscreen;
+			if (imgui_panel::capture_frames) {
+				frame_capture.start(imgui_panel::capture_prefix, settings);
+			}
+			else {
+				frame_capture.stop();
+			}
+		}
+		frame_capture.capture();
+		if (frame_capture.capturing() && frame_capture.failed()) {
+			std::cerr << "Could not write an image starting with " << imgui_panel::capture_prefix << '\n';
+			frame_capture.stop();
+			imgui_panel::capture_frames = false;
+		}
+		if (offscreen) {
+			render_target.unbind();
+		}
+		imgui_panel::frames_captured = frame_capture.frames_written();
+		imgui_panel::frames_capture_dropped = frame_capture.frames_dropped();
+		if (offscreen && --offscreen_frames == 0) {
+			window.shouldClose();
+		}
+
+		if (pool.budget() != std::size_t(imgui_panel::model_budget_mb) << 20) {
+			pool.set_budget(std::size_t(imgui_panel::model_budget_mb) << 20);
+		}
+		imgui_panel::kept_models = int(pool.size());
+		imgui_panel::kept_model_mb = float(pool.bytes()) / float(1 << 20);
+
+		profiler::collect();
+
+		// Start or stop recording the trace from the panel
+		if (imgui_panel::record_trace != profiler::tracing()) {
+			if (!imgui_panel::record_trace) {
+				profiler::stop_trace();
+			}
+			else if (!profiler::start_trace(imgui_panel::trace_path)) {
+				std::cerr << "Could not open trace file " << imgui_panel::trace_path << '\n';
+				imgui_panel::record_trace = false;
+			}
+		}
 		});
 
+	// Finish the trace, trajectory, meshes and images if they are still recording
+	profiler::stop_trace();
+	recorder.stop();
+	exporter.stop();
+	frame_capture.stop();
+	if (offscreen) {
+		std::cout << frame_capture.frames_written() << " frames written, " << frame_capture.frames_dropped() << " dropped\n";
+	}
+
 	return EXIT_SUCCESS;
 }
\ No newline at end of file
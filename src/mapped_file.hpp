@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+//A whole file mapped read-only into memory. Nothing is read until the pages are touched.
+class MappedFile {
+public:
+	MappedFile() = default;
+	~MappedFile();
+
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	//Unmaps any previous file. False if the file cannot be opened or is empty.
+	bool open(const std::string& path);
+	void close();
+
+	bool is_open() const { return bytes != nullptr; }
+	const unsigned char* data() const { return bytes; }
+	std::size_t size() const { return length; }
+	//Whether count values of T fit in the file from offset, which is aligned for T. Checked
+	//without adding, so a damaged file's huge offsets and counts cannot wrap around.
+	template <typename T>
+	bool holds(std::uint64_t offset, std::uint64_t count) const {
+		return offset <= length && count <= (length - offset) / sizeof(T) && offset % alignof(T) == 0;
+	}
+
+private:
+	const unsigned char* bytes = nullptr;
+	std::size_t length = 0;
+#ifdef _WIN32
+	void* file = nullptr;
+	void* mapping = nullptr;
+#endif
+};
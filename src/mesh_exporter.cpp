@@ -0,0 +1,196 @@
+#include "mesh_exporter.hpp"
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+namespace simulation {
+	namespace mesh_export {
+		namespace {
+			bool little_endian() {
+				const std::uint16_t one = 1;
+				unsigned char first;
+				std::memcpy(&first, &one, 1);
+				return first == 1;
+			}
+
+			void append(std::vector<char>& bytes, const void* data, std::size_t size) {
+				const char* begin = static_cast<const char*>(data);
+				bytes.insert(bytes.end(), begin, begin + size);
+			}
+
+			void append_text(std::vector<char>& bytes, const char* format, ...) {
+				char text[512];
+				va_list arguments;
+				va_start(arguments, format);
+				int length = std::vsnprintf(text, sizeof(text), format, arguments);
+				va_end(arguments);
+				if (length > 0) {
+					append(bytes, text, std::min(std::size_t(length), sizeof(text) - 1));
+				}
+			}
+
+			//The vertices are written as they are in memory
+			static_assert(sizeof(glm::vec3) == 3 * sizeof(float), "PLY vertices are three packed floats");
+		}
+
+		Exporter::~Exporter() {
+			stop();
+		}
+
+		bool Exporter::start(const std::string& path_prefix, const models::GenericModel& model, const Settings& settings) {
+			stop();
+			models::Surface surface = model.surface();
+			if (surface.triangles.empty()) {
+				return false;
+			}
+			prefix = path_prefix;
+			format = settings.format;
+			surface_masses = std::move(surface.masses);
+			triangle_count = surface.triangles.size() / 3;
+			positions.resize(model.mass_count());
+			next_frame = 0;
+			exported = 0;
+			write_failed = false;
+
+			//The connectivity is the same in every file
+			faces.clear();
+			if (format == Format::PLY) {
+				faces.reserve(triangle_count * (1 + 3 * sizeof(std::int32_t)));
+				for (std::size_t t = 0; t < triangle_count; t++) {
+					unsigned char corners = 3;
+					append(faces, &corners, 1);
+					for (int c = 0; c < 3; c++) {
+						std::int32_t vertex = std::int32_t(surface.triangles[3 * t + c]);
+						append(faces, &vertex, sizeof(vertex));
+					}
+				}
+			} else {
+				char line[64];
+				for (std::size_t t = 0; t < triangle_count; t++) {
+					//OBJ counts from 1
+					int length = std::snprintf(line, sizeof(line), "f %u %u %u\n", surface.triangles[3 * t] + 1,
+						surface.triangles[3 * t + 1] + 1, surface.triangles[3 * t + 2] + 1);
+					append(faces, line, std::size_t(length));
+				}
+			}
+
+			std::size_t worker_count = settings.workers;
+			if (worker_count == 0) {
+				worker_count = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+			}
+			std::size_t buffer_count = std::max(settings.buffer_count, worker_count);
+			jobs.resize(buffer_count);
+			free_jobs.clear();
+			pending.clear();
+			free_jobs.reserve(buffer_count);
+			pending.reserve(buffer_count);
+			for (std::size_t n = 0; n < buffer_count; n++) {
+				jobs[n].vertices.resize(surface_masses.size());
+				free_jobs.push_back(n);
+			}
+			stopping = false;
+			for (std::size_t n = 0; n < worker_count; n++) {
+				workers.emplace_back([this] { run(); });
+			}
+			return true;
+		}
+
+		void Exporter::stop() {
+			if (workers.empty()) {
+				return;
+			}
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				stopping = true;
+			}
+			work.notify_all();
+			for (std::thread& worker : workers) {
+				worker.join();
+			}
+			workers.clear();
+		}
+
+		void Exporter::export_frame(const models::GenericModel& model) {
+			if (workers.empty() || model.mass_count() != positions.size()) {
+				return;
+			}
+			std::size_t n;
+			{
+				//The backpressure: wait for the workers to free a buffer
+				std::unique_lock<std::mutex> lock(mutex);
+				freed.wait(lock, [this] { return !free_jobs.empty(); });
+				n = free_jobs.back();
+				free_jobs.pop_back();
+			}
+
+			Job& job = jobs[n];
+			job.frame = next_frame++;
+			job.time = model.time;
+			model.gather_positions(positions.data());
+			for (std::size_t v = 0; v < surface_masses.size(); v++) {
+				job.vertices[v] = positions[surface_masses[v]];
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				pending.push_back(n);
+			}
+			work.notify_one();
+		}
+
+		void Exporter::run() {
+			//Each worker keeps its own file buffer
+			std::vector<char> bytes;
+			std::unique_lock<std::mutex> lock(mutex);
+			while (true) {
+				work.wait(lock, [this] { return stopping || !pending.empty(); });
+				if (pending.empty()) {
+					return;
+				}
+				//Oldest first, there are only a few
+				std::size_t n = pending.front();
+				pending.erase(pending.begin());
+				lock.unlock();
+
+				if (write(jobs[n], bytes)) {
+					exported.fetch_add(1, std::memory_order_relaxed);
+				} else {
+					write_failed = true;
+				}
+
+				lock.lock();
+				free_jobs.push_back(n);
+				freed.notify_one();
+			}
+		}
+
+		bool Exporter::write(const Job& job, std::vector<char>& bytes) const {
+			bytes.clear();
+			char name[32];
+			std::snprintf(name, sizeof(name), "_%06llu.%s", (unsigned long long)job.frame, format == Format::PLY ? "ply" : "obj");
+
+			if (format == Format::PLY) {
+				append_text(bytes,
+					"ply\nformat %s 1.0\ncomment time %.9g\nelement vertex %zu\nproperty float x\nproperty float y\nproperty float z\n"
+					"element face %zu\nproperty list uchar int vertex_indices\nend_header\n",
+					little_endian() ? "binary_little_endian" : "binary_big_endian", job.time, job.vertices.size(), triangle_count);
+				append(bytes, job.vertices.data(), job.vertices.size() * sizeof(glm::vec3));
+			} else {
+				append_text(bytes, "# time %.9g\n", job.time);
+				for (const glm::vec3& vertex : job.vertices) {
+					append_text(bytes, "v %.7g %.7g %.7g\n", vertex.x, vertex.y, vertex.z);
+				}
+			}
+
+			std::FILE* file = std::fopen((prefix + name).c_str(), "wb");
+			if (!file) {
+				return false;
+			}
+			bool written = std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size()
+				&& std::fwrite(faces.data(), 1, faces.size(), file) == faces.size();
+			return (std::fclose(file) == 0) && written;
+		}
+	} // namespace mesh_export
+} // namespace simulation
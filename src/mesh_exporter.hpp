@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "models.hpp"
+
+//Writes a model's surface as one mesh file per frame, prefix_000000.ply and so on. The faces are
+//formatted once when the export starts, each frame only adds its vertex positions.
+namespace simulation {
+	namespace mesh_export {
+		enum class Format {
+			//Binary, in the machine's byte order
+			PLY,
+			OBJ
+		};
+
+		struct Settings {
+			Format format = Format::PLY;
+			//Threads formatting and writing the files, 0 for one less than the hardware threads
+			std::size_t workers = 0;
+			//Frames copied but not yet written. Exporting waits while they are all in use.
+			std::size_t buffer_count = 16;
+		};
+
+		//Copies each frame's surface positions on the calling thread and leaves the formatting
+		//and writing to a pool of workers. The buffers are allocated when the export starts, and
+		//when the workers fall behind export_frame() waits for one to be free rather than
+		//growing, so the memory used is bounded.
+		class Exporter {
+		public:
+			Exporter() = default;
+			~Exporter();
+
+			Exporter(const Exporter&) = delete;
+			Exporter& operator=(const Exporter&) = delete;
+
+			//Stops any export in progress. False if the model has no surface.
+			bool start(const std::string& prefix, const models::GenericModel& model, const Settings& settings = Settings());
+			//Waits for the queued frames to be written
+			void stop();
+			bool exporting() const { return !workers.empty(); }
+
+			void export_frame(const models::GenericModel& model);
+
+			std::uint64_t frames_exported() const { return exported.load(std::memory_order_relaxed); }
+			//Set by a worker if a file could not be written
+			bool failed() const { return write_failed.load(std::memory_order_relaxed); }
+
+		private:
+			struct Job {
+				std::uint64_t frame = 0;
+				double time = 0.0;
+				std::vector<glm::vec3> vertices;
+			};
+
+			void run();
+			bool write(const Job& job, std::vector<char>& bytes) const;
+
+			std::string prefix;
+			Format format = Format::PLY;
+			std::vector<std::uint32_t> surface_masses;
+			std::size_t triangle_count = 0;
+			//The faces part of every file
+			std::vector<char> faces;
+			//Every mass of the model, only used by the exporting thread
+			std::vector<glm::vec3> positions;
+			std::uint64_t next_frame = 0;
+
+			std::vector<Job> jobs;
+			std::vector<std::size_t> free_jobs;
+			std::vector<std::size_t> pending;
+			std::mutex mutex;
+			std::condition_variable work;
+			std::condition_variable freed;
+			bool stopping = false;
+			std::vector<std::thread> workers;
+			std::atomic<std::uint64_t> exported{ 0 };
+			std::atomic<bool> write_failed{ false };
+		};
+	} // namespace mesh_export
+} // namespace simulation
@@ -0,0 +1,106 @@
+#include "model_pool.hpp"
+
+#include <algorithm>
+
+namespace simulation {
+	namespace models {
+		ModelPool::Kept ModelPool::acquire(int key, const Builder& build, const Settings& settings) {
+			Entry* entry = find(key);
+			if (!entry) {
+				add(key, build(), settings, 0);
+				entry = &entries.back();
+			}
+			entry->last_used = ++clock;
+			Kept kept{ entry->model.get(), entry->settings };
+			evict();
+			return kept;
+		}
+
+		GenericModel& ModelPool::replace(int key, std::unique_ptr<GenericModel> model, const Settings& settings) {
+			Entry* entry = find(key);
+			if (entry) {
+				used_bytes -= entry->bytes;
+				entry->bytes = estimated_bytes(*model);
+				entry->model = std::move(model);
+				entry->settings = settings;
+				used_bytes += entry->bytes;
+			} else {
+				add(key, std::move(model), settings, 0);
+				entry = &entries.back();
+			}
+			entry->last_used = ++clock;
+			GenericModel& replaced = *entry->model;
+			evict();
+			return replaced;
+		}
+
+		void ModelPool::keep_settings(int key, const Settings& settings) {
+			if (Entry* entry = find(key)) {
+				entry->settings = settings;
+			}
+		}
+
+		bool ModelPool::prebuild(int key, const Builder& build, const Settings& settings) {
+			if (contains(key) || used_bytes >= budget_bytes) {
+				return false;
+			}
+			add(key, build(), settings, 0);
+			//Without room it goes again straight away, rather than a model built earlier
+			if (used_bytes > budget_bytes) {
+				used_bytes -= entries.back().bytes;
+				entries.pop_back();
+				return false;
+			}
+			return true;
+		}
+
+		void ModelPool::set_budget(std::size_t bytes) {
+			budget_bytes = bytes;
+			evict();
+		}
+
+		std::size_t ModelPool::estimated_bytes(const GenericModel& model) {
+			return model.mass_count() * (sizeof(primatives::Mass) + 3 * sizeof(glm::vec3))
+				+ model.spring_count() * (sizeof(primatives::Spring) + 2 * sizeof(std::uint32_t));
+		}
+
+		ModelPool::Entry* ModelPool::find(int key) {
+			for (Entry& entry : entries) {
+				if (entry.key == key) {
+					return &entry;
+				}
+			}
+			return nullptr;
+		}
+
+		const ModelPool::Entry* ModelPool::find(int key) const {
+			for (const Entry& entry : entries) {
+				if (entry.key == key) {
+					return &entry;
+				}
+			}
+			return nullptr;
+		}
+
+		void ModelPool::add(int key, std::unique_ptr<GenericModel> model, const Settings& settings, std::uint64_t last_used) {
+			std::size_t bytes = estimated_bytes(*model);
+			entries.push_back({ key, std::move(model), settings, bytes, last_used });
+			used_bytes += bytes;
+		}
+
+		void ModelPool::evict() {
+			while (used_bytes > budget_bytes && entries.size() > 1) {
+				std::vector<Entry>::iterator newest = std::max_element(entries.begin(), entries.end(),
+					[](const Entry& a, const Entry& b) { return a.last_used < b.last_used; });
+				std::vector<Entry>::iterator oldest = entries.end();
+				for (std::vector<Entry>::iterator it = entries.begin(); it != entries.end(); ++it) {
+					if (it != newest && (oldest == entries.end() || it->last_used < oldest->last_used)) {
+						oldest = it;
+					}
+				}
+				used_bytes -= oldest->bytes;
+				entries.erase(oldest);
+			}
+		}
+	} // namespace models
+} // namespace simulation
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "models.hpp"
+
+//Models kept alive after they are switched away from, with their state, renderables and solver
+//settings, so picking one again is instant. The least recently used are destroyed when the
+//estimated memory of the kept models goes over the budget. Models are built (and destroyed) on
+//the thread with the GL context, since they own renderables.
+namespace simulation {
+	namespace models {
+		class ModelPool {
+		public:
+			using Builder = std::function<std::unique_ptr<GenericModel>()>;
+
+			//What the model runs with, kept while it is switched away from
+			struct Settings {
+				float dt = 0.f;
+				int iterations_per_frame = 1;
+			};
+
+			struct Kept {
+				GenericModel* model = nullptr;
+				Settings settings;
+			};
+
+			explicit ModelPool(std::size_t budget_bytes) : budget_bytes(budget_bytes) {}
+
+			//The key's model, built with the settings if it is not kept. It becomes the most recently
+			//used, and the least recently used others are evicted until the pool fits its budget.
+			Kept acquire(int key, const Builder& build, const Settings& settings);
+			//Puts a new model in the key's place, e.g. one restored from a checkpoint
+			GenericModel& replace(int key, std::unique_ptr<GenericModel> model, const Settings& settings);
+			//Called when switching away from the key, so it comes back as it was left
+			void keep_settings(int key, const Settings& settings);
+
+			//Builds the key's model before it is picked, as the least recently used. False if it is
+			//kept already or does not fit under the budget.
+			bool prebuild(int key, const Builder& build, const Settings& settings);
+
+			bool contains(int key) const { return find(key) != nullptr; }
+			std::size_t size() const { return entries.size(); }
+			std::size_t bytes() const { return used_bytes; }
+			std::size_t budget() const { return budget_bytes; }
+			//Evicts down to a new budget, keeping the most recently used model
+			void set_budget(std::size_t bytes);
+
+			//Rough, from the counts: the mass and spring arrays, the previous positions kept for
+			//interpolation and the vertex and index buffers on the GPU
+			static std::size_t estimated_bytes(const GenericModel& model);
+
+		private:
+			struct Entry {
+				int key;
+				std::unique_ptr<GenericModel> model;
+				Settings settings;
+				std::size_t bytes;
+				std::uint64_t last_used;
+			};
+
+			Entry* find(int key);
+			const Entry* find(int key) const;
+			void add(int key, std::unique_ptr<GenericModel> model, const Settings& settings, std::uint64_t last_used);
+			//Least recently used first, never the most recently used
+			void evict();
+
+			std::vector<Entry> entries;
+			std::size_t budget_bytes;
+			std::size_t used_bytes = 0;
+			std::uint64_t clock = 0;
+		};
+	} // namespace models
+} // namespace simulation
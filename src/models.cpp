@@ -1,6 +1,11 @@
 #include "models.hpp"
+#include "checkpoint.hpp"
+#include "profiler.hpp"
+#include "topology_cache.hpp"
 #include <iostream>
 #include <math.h>
+#include <limits>
+#include <algorithm>
 
 namespace simulation {
 	namespace primatives {
@@ -8,34 +13,144 @@ namespace simulation {
 	}// namespace primatives
 
 	namespace models {
+		//Index pairs of the masses each spring joins, for drawing the springs from the mass positions
+		static std::vector<std::uint32_t> spring_indices(const std::vector<primatives::Mass>& masses, const std::vector<primatives::Spring>& springs) {
+			std::vector<std::uint32_t> indices;
+			indices.reserve(2*springs.size());
+			for (const primatives::Spring& spring : springs) {
+				indices.push_back(std::uint32_t(spring.mass_a - masses.data()));
+				indices.push_back(std::uint32_t(spring.mass_b - masses.data()));
+			}
+			return indices;
+		}
+
+		//Copies the mass positions, kept as the previous state for display interpolation
+		static void copy_positions(const std::vector<primatives::Mass>& masses, std::vector<glm::vec3>& positions) {
+			positions.resize(masses.size());
+			for (std::size_t n=0; n<masses.size(); n++){
+				positions[n] = masses[n].p;
+			}
+		}
+
+		//Model constants kept in a checkpoint, in the same order they were saved. The caller checks
+		//the checkpoint has as many.
+		static void read_parameters(const checkpoint::Snapshot& snapshot, std::initializer_list<float*> parameters) {
+			const float* saved = snapshot.parameters();
+			for (float* parameter : parameters) {
+				*parameter = *saved++;
+			}
+		}
+
+		//Bumped when a generator changes which masses it joins, so old cached topologies are missed
+		constexpr std::uint32_t topology_version = 2;
+
+		//From a mass at (i, j, k) of a width x height x length lattice, indexed (i*height + j)*length + k,
+		//to a neighbour it is joined to
+		struct LatticeOffset {
+			int i;
+			int j;
+			int k;
+		};
+
+		//Links of the lattice in closed form: each offset joins every mass whose neighbour is inside
+		static std::size_t lattice_link_count(const std::vector<LatticeOffset>& offsets, int width, int height, int length) {
+			std::size_t count = 0;
+			for (const LatticeOffset& o : offsets) {
+				count += std::size_t(std::max(width - std::abs(o.i), 0)) * std::size_t(std::max(height - std::abs(o.j), 0))
+					* std::size_t(std::max(length - std::abs(o.k), 0));
+			}
+			return count;
+		}
+
+		//Joins the masses with the topology cached for the key. On a miss each mass is joined to its
+		//neighbours at the offsets, which all come before it in index order and are listed in
+		//increasing index order, and the topology is cached for the next time. The rest lengths are
+		//the distances between the masses as they are placed.
+		static void link_springs(const topology::Key& key, std::vector<primatives::Mass>& masses, std::vector<primatives::Spring>& springs,
+			float k, float damping, BuildProgress* progress, const std::vector<LatticeOffset>& offsets, int width, int height, int length) {
+			topology::Cached cached;
+			std::vector<topology::Link> generated;
+			const topology::Link* links = nullptr;
+			std::size_t link_count = 0;
+			if (cached.open(key)) {
+				links = cached.links();
+				link_count = cached.link_count();
+			} else {
+				generated.resize(lattice_link_count(offsets, width, height, length));
+				std::size_t n = 0;
+				for (int i=0; i<width; i++){
+					if (progress) {
+						progress->store(float(i) / float(width), std::memory_order_relaxed);
+					}
+					for (int j=0; j<height; j++){
+						for (int l=0; l<length; l++){
+							std::size_t a = (std::size_t(i)*height + j)*length + l;
+							for (const LatticeOffset& o : offsets) {
+								int ni = i + o.i;
+								int nj = j + o.j;
+								int nl = l + o.k;
+								if (ni<0 || ni>=width || nj<0 || nj>=height || nl<0 || nl>=length) {
+									continue;
+								}
+								std::size_t b = (std::size_t(ni)*height + nj)*length + nl;
+								generated[n++] = { std::uint32_t(a), std::uint32_t(b), glm::length(masses[a].p - masses[b].p) };
+							}
+						}
+					}
+				}
+				topology::write(key, generated);
+				links = generated.data();
+				link_count = generated.size();
+			}
+
+			springs.resize(link_count);
+			for (std::size_t n=0; n<link_count; n++){
+				springs[n].mass_a = &masses[links[n].mass_a];
+				springs[n].mass_b = &masses[links[n].mass_b];
+				springs[n].k = k;
+				springs[n].r = links[n].r;
+				springs[n].c = springs[n].critical_damp(springs[n].mass_a->mass)*damping;
+			}
+			if (progress) {
+				progress->store(1.f, std::memory_order_relaxed);
+			}
+		}
+
 		//////////////////////////////////////////////////
 		////            MassOnSpringModel             ////----------------------------------------------------------
 		//////////////////////////////////////////////////
 
-		MassOnSpringModel::MassOnSpringModel()
-			: mass_geometry(givr::geometry::Radius(0.2f))
-			, mass_style(givr::style::Colour(1.f, 0.f, 1.f), givr::style::LightPosition(100.f, 100.f, 100.f))
+		MassOnSpringModel::MassOnSpringModel(const MassOnSpringParameters& parameters)
+			: mass_geometry()
+			, mass_style(givr::style::Colour(1.f, 0.f, 1.f), givr::style::LightPosition(100.f, 100.f, 100.f), givr::style::PointRadius(0.2f))
 			, spring_geometry()
 			, spring_style(givr::style::Colour(1.f, 0.f, 1.f))
 		{
 			// Link up (Static elements)
 			mass_a.fixed = true;
 			mass_b.fixed = false;
-			mass_b.mass = 0.5;
+			mass_b.mass = parameters.mass;
 			mass_b.f_g.y = -9.81*mass_b.mass;
 			spring.mass_a = &mass_a;
 			spring.mass_b = &mass_b;
-			spring.r = 5;
-			spring.k = 15;
-			// Underdamped: 10% of critical damp
-			spring.c = spring.critical_damp(mass_b.mass)*0.1;
+			spring.r = parameters.rest_length;
+			spring.k = parameters.k;
+			// Underdamped: 10% of critical damp by default
+			spring.c = spring.critical_damp(mass_b.mass)*parameters.damping;
 
 			// Reset Dynamic elements
 			reset();
 
 			// Render
-			mass_render = givr::createInstancedRenderable(mass_geometry, mass_style);
+			positions.resize(2);
+			spring_geometry.setIndices({0, 1});
+		}
+
+		void MassOnSpringModel::create_renderables() {
+			mass_render = givr::createRenderable(mass_geometry, mass_style);
 			spring_render = givr::createRenderable(spring_geometry, spring_style);
+			givr::shareVertices(mass_render, position_buffer);
+			givr::shareVertices(spring_render, position_buffer);
 		}
 		
 		void MassOnSpringModel::reset() {
@@ -45,11 +160,50 @@ namespace simulation {
 			mass_b.p = { 0.f,-5,0.f};
 			mass_b.v = { 0.f,0.f,0.f };
 			released = false;
+			save_previous();
 			//This model can start vertical and be just a spring in the y direction only (like currently set up)
 		}
 
+		void MassOnSpringModel::save_previous() {
+			previous_positions.assign({ mass_a.p, mass_b.p });
+		}
+
+		void MassOnSpringModel::save(checkpoint::State& state) const {
+			state.masses = { mass_a, mass_b };
+			state.springs = { { 0, 1, spring.k, spring.r, spring.l, spring.c } };
+			state.parameters = { g.x, g.y, g.z, released ? 1.f : 0.f };
+		}
+
+		bool MassOnSpringModel::restore(const checkpoint::Snapshot& snapshot) {
+			const checkpoint::Header& header = snapshot.header();
+			if (header.mass_count != 2 || header.spring_count != 1 || header.parameter_count != 4) {
+				return false;
+			}
+			float was_released = 0.f;
+			read_parameters(snapshot, { &g.x, &g.y, &g.z, &was_released });
+			released = was_released != 0.f;
+			mass_a = snapshot.masses()[0];
+			mass_b = snapshot.masses()[1];
+			const checkpoint::SpringRecord& record = snapshot.springs()[0];
+			spring.k = record.k;
+			spring.r = record.r;
+			spring.l = record.l;
+			spring.c = record.c;
+			save_previous();
+			return true;
+		}
+
+		void MassOnSpringModel::gather_positions(glm::vec3* positions) const {
+			positions[0] = mass_a.p;
+			positions[1] = mass_b.p;
+		}
+
 		void MassOnSpringModel::step(float dt) {
-			spring.apply_forces();
+			{
+				PROFILE_SCOPE(SpringForces);
+				spring.apply_forces();
+			}
+			PROFILE_SCOPE(Integration);
 			// Pull the string down
 			if (!released && mass_b.p.y>-8.f){
 				mass_b.p.y -= 0.025;
@@ -64,21 +218,19 @@ namespace simulation {
 
 		void MassOnSpringModel::render(const ModelViewContext& view) {
 
-			//Add Mass render
-			givr::addInstance(mass_render, glm::translate(glm::mat4(1.f), mass_a.p));
-			givr::addInstance(mass_render, glm::translate(glm::mat4(1.f), mass_b.p));
-
-			//Clear and add springs
-			spring_geometry.segments().clear();
-			spring_geometry.push_back(
-				givr::geometry::Line(
-					givr::geometry::Point1(spring.mass_a->p), 
-					givr::geometry::Point2(spring.mass_b->p)
-				)
-			);
-			givr::updateRenderable(spring_geometry, spring_style, spring_render);
+			{
+				PROFILE_SCOPE(GeometryBuild);
+				positions[0] = glm::lerp(previous_positions[0], mass_a.p, alpha);
+				positions[1] = glm::lerp(previous_positions[1], mass_b.p, alpha);
+			}
+			{
+				//Upload the positions once, the masses and the spring both read them
+				PROFILE_SCOPE(BufferUpload);
+				position_buffer.upload(positions);
+			}
 
 			//Render
+			PROFILE_SCOPE(Draw);
 			givr::style::draw(mass_render, view);
 			givr::style::draw(spring_render, view);
 		}
@@ -87,43 +239,58 @@ namespace simulation {
 		////           ChainPendulumModel             ////----------------------------------------------------------
 		//////////////////////////////////////////////////
 
-		ChainPendulumModel::ChainPendulumModel() 
-			: mass_geometry(givr::geometry::Radius(0.2f))
-			, mass_style(givr::style::Colour(1.f, 0.f, 1.f), givr::style::LightPosition(100.f, 100.f, 100.f))
+		ChainPendulumModel::ChainPendulumModel(const ChainPendulumParameters& parameters)
+			: mass_geometry()
+			, mass_style(givr::style::Colour(1.f, 0.f, 1.f), givr::style::LightPosition(100.f, 100.f, 100.f), givr::style::PointRadius(0.2f))
 			, spring_geometry()
 			, spring_style(givr::style::Colour(1.f, 0.f, 1.f))
 		{
 			//Link up (Static elements)
-			float mass_size = 0.5f;
-			masses.resize(11);
-			masses[0].fixed = true;
-			for (int i=1; i<11; i++){
-				masses[i].fixed = false;
-				masses[i].mass = mass_size;
-				masses[i].f_g.y = -9.81*masses[i].mass;
+			mass_size = parameters.mass;
+			k = parameters.k;
+			spacing = parameters.spacing;
+			std::size_t count = std::max<std::size_t>(parameters.mass_count, 2);
+			masses.resize(count);
+			for (std::uint32_t pin : parameters.pins){
+				if (pin < count) {
+					masses[pin].fixed = true;
+				}
+			}
+			for (primatives::Mass& mass : masses){
+				if (!mass.fixed) {
+					mass.mass = mass_size;
+					mass.f_g.y = -9.81*mass.mass;
+				}
 			}
 
-			springs.resize(10);
+			springs.resize(count-1);
 			reset();
-			for (int i=0; i<10; i++){
+			for (std::size_t i=0; i<count-1; i++){
 				springs[i].mass_a = &masses[i];
 				springs[i].mass_b = &masses[i+1];
-				springs[i].k = 100;
+				springs[i].k = k;
 				float d = glm::length(masses[i+1].p - masses[i].p);
 				springs[i].r = d;
-				springs[i].c = springs[i].critical_damp(springs[i].mass_a->mass)*0.25;
+				springs[i].c = springs[i].critical_damp(springs[i].mass_a->mass)*parameters.damping;
 			}
 			//Reset Dynamic elements
 			reset();
 
 			// Render
-			mass_render = givr::createInstancedRenderable(mass_geometry, mass_style);
+			positions.resize(masses.size());
+			spring_geometry.setIndices(spring_indices(masses, springs));
+		}
+
+		void ChainPendulumModel::create_renderables() {
+			mass_render = givr::createRenderable(mass_geometry, mass_style);
 			spring_render = givr::createRenderable(spring_geometry, spring_style);
+			givr::shareVertices(mass_render, position_buffer);
+			givr::shareVertices(spring_render, position_buffer);
 		}
 
 		void ChainPendulumModel::reset() {
 			float x = 0;
-			float r = 1.5f;
+			float r = spacing;
 			for (primatives::Mass& mass : masses){
 				mass.p = { x,0.f,0.f };
 				mass.v = { 0.f,0.f,0.f };
@@ -137,18 +304,51 @@ namespace simulation {
 				spring.f_s = { 0.f,0.f,0.f };
 				spring.f_d = { 0.f,0.f,0.f };
 			}
+			save_previous();
 			//The model should start non-vertical so we can see swaying action
 		}
 
+		void ChainPendulumModel::save_previous() {
+			copy_positions(masses, previous_positions);
+		}
+
+		void ChainPendulumModel::save(checkpoint::State& state) const {
+			checkpoint::save_masses(masses, springs, state);
+			state.parameters = { g.x, g.y, g.z, mass_size, k };
+		}
+
+		bool ChainPendulumModel::restore(const checkpoint::Snapshot& snapshot) {
+			std::initializer_list<float*> parameters = { &g.x, &g.y, &g.z, &mass_size, &k };
+			if (snapshot.header().parameter_count != parameters.size() || !checkpoint::restore_masses(snapshot, masses, springs)) {
+				return false;
+			}
+			read_parameters(snapshot, parameters);
+			save_previous();
+			return true;
+		}
+
+		void ChainPendulumModel::gather_positions(glm::vec3* positions) const {
+			for (std::size_t n=0; n<masses.size(); n++){
+				positions[n] = masses[n].p;
+			}
+		}
+
 		void ChainPendulumModel::step(float dt) {
-			for (primatives::Spring& spring : springs){
-				spring.apply_forces();
+			{
+				PROFILE_SCOPE(SpringForces);
+				for (primatives::Spring& spring : springs){
+					spring.apply_forces();
+				}
 			}
-			for (primatives::Mass& mass : masses){
-				float k = 0.05;
-				glm::vec3 f_air = -k*mass.v;
-				mass.f_i += mass.f_g + f_air;
+			{
+				PROFILE_SCOPE(ExternalForces);
+				for (primatives::Mass& mass : masses){
+					float k = 0.05;
+					glm::vec3 f_air = -k*mass.v;
+					mass.f_i += mass.f_g + f_air;
+				}
 			}
+			PROFILE_SCOPE(Integration);
 			for (primatives::Mass& mass : masses){
 				if (!mass.fixed) {
 					mass.integrate(dt);
@@ -159,24 +359,20 @@ namespace simulation {
 
 		void ChainPendulumModel::render(const ModelViewContext& view) {
 
-			//Add Mass render
-			for (const primatives::Mass& mass : masses) {
-				givr::addInstance(mass_render, glm::translate(glm::mat4(1.f), mass.p));
+			{
+				PROFILE_SCOPE(GeometryBuild);
+				for (std::size_t n=0; n<masses.size(); n++){
+					positions[n] = glm::lerp(previous_positions[n], masses[n].p, alpha);
+				}
 			}
-
-			//Clear and add springs
-			spring_geometry.segments().clear();
-			for (const primatives::Spring& spring : springs) {
-				spring_geometry.push_back(
-					givr::geometry::Line(
-						givr::geometry::Point1(spring.mass_a->p),
-						givr::geometry::Point2(spring.mass_b->p)
-					)
-				);
+			{
+				//Upload the positions once, the masses and the springs both read them
+				PROFILE_SCOPE(BufferUpload);
+				position_buffer.upload(positions);
 			}
-			givr::updateRenderable(spring_geometry, spring_style, spring_render);
 
 			//Render
+			PROFILE_SCOPE(Draw);
 			givr::style::draw(mass_render, view);
 			givr::style::draw(spring_render, view);
 		}
@@ -184,50 +380,50 @@ namespace simulation {
 		////              CubeOfJelly                 ////----------------------------------------------------------
 		//////////////////////////////////////////////////
 
-		CubeOfJellyModel::CubeOfJellyModel() 
+		CubeOfJellyModel::CubeOfJellyModel(const CubeOfJellyParameters& parameters, BuildProgress* progress)
 			: jelly_geometry()
 			, jelly_style(givr::style::Colour(1.f, 0.f, 1.f), givr::style::LightPosition(100.f, 100.f, 100.f))
 			, floor_geometry()
 			, floor_style(givr::style::Phong(givr::style::Colour(1., 1., 0.1529), givr::style::LightPosition(100.f, 100.f, 100.f)))
 		{
 			//Link up (Static elements)
-			float size = CubeOfJellyModel::length * CubeOfJellyModel::height * CubeOfJellyModel::width;
+			width = std::max<std::uint32_t>(parameters.width, 1);
+			height = std::max<std::uint32_t>(parameters.height, 1);
+			length = std::max<std::uint32_t>(parameters.length, 1);
+			ground = parameters.ground;
+			r = parameters.spacing;
+			k = parameters.k;
+			std::size_t size = std::size_t(width) * std::size_t(height) * std::size_t(length);
 			masses.resize(size);
-			for (int i=0; i<size; i++){
+			for (std::size_t i=0; i<size; i++){
 				masses[i].fixed = false;
-				masses[i].mass = 0.1;
+				masses[i].mass = parameters.mass;
 				masses[i].f_g.y = -9.81*masses[i].mass;
 			}
 
-			springs.resize(size*25);
-			float n = 0;
 			//Reset to set mass positions, so we can place springs
 			reset();
-			for (int i=0; i<masses.size(); i++){
-				for (int j=0; j<i; j++){
-					float d = glm::length(masses[i].p - masses[j].p);
-					float thresh = glm::length(glm::vec3{0.f,0.f,0.f} - glm::vec3{r,r,r});
-					//Add springs
-					if (d<=thresh){
-						springs[n].mass_a = &masses[i];
-						springs[n].mass_b = &masses[j];
-						springs[n].k = k;
-						springs[n].r = d;
-						springs[n].c = springs[n].critical_damp(springs[n].mass_a->mass)*0.25;
-						n+=1.f;
-					}
-				}
-			}
-			springs.resize(n);
+			//Every pair of masses within a lattice cell diagonal is joined: along the edges, across the
+			//faces and through the cell
+			const std::vector<LatticeOffset> offsets = {
+				{-1,-1,-1}, {-1,-1,0}, {-1,-1,1}, {-1,0,-1}, {-1,0,0}, {-1,0,1}, {-1,1,-1}, {-1,1,0}, {-1,1,1},
+				{0,-1,-1}, {0,-1,0}, {0,-1,1},
+				{0,0,-1},
+			};
+			link_springs(topology::make_key("CubeOfJelly", topology_version, width, height, length, r, masses.size()),
+				masses, springs, k, parameters.damping, progress, offsets, int(width), int(height), int(length));
 
 			//Reset Dynamic elements
 			reset();
 
 			// Render
-
-			jelly_render = givr::createRenderable(jelly_geometry, jelly_style);
+			buildSurface();
 			floor_geometry.push_back(givr::geometry::Point1(-500.f, ground, 500.f), givr::geometry::Point2(-500.f, ground, -500.f), givr::geometry::Point3(500.f, ground, 500.f));
 			floor_geometry.push_back(givr::geometry::Point1(-500.f, ground, -500.f), givr::geometry::Point2(500.f, ground, -500.f), givr::geometry::Point3(500.f, ground, 500.f));
+		}
+
+		void CubeOfJellyModel::create_renderables() {
+			jelly_render = givr::createRenderable(jelly_geometry, jelly_style);
 			floor_render = givr::createRenderable(floor_geometry, floor_style);
 		}
 
@@ -262,17 +458,142 @@ namespace simulation {
 				spring.f_s = { 0.f,0.f,0.f };
 				spring.f_d = { 0.f,0.f,0.f };
 			}
+			save_previous();
+		}
+
+		void CubeOfJellyModel::save_previous() {
+			copy_positions(masses, previous_positions);
+		}
+
+		void CubeOfJellyModel::buildSurface() {
+			// The surface topology never changes, so it is extracted once by walking the six
+			// faces of the lattice (rather than every cell). Only the masses on those faces
+			// are streamed to the renderer, indexed through surface_masses. Every face is
+			// wound counter-clockwise from outside the cube so the vertex normals point out.
+			int w = width;
+			int h = height;
+			int l = length;
+			constexpr std::uint32_t unassigned = std::numeric_limits<std::uint32_t>::max();
+			std::vector<std::uint32_t> surface_index(masses.size(), unassigned);
+			std::vector<std::uint32_t> triangles;
+			surface_masses.clear();
+
+			auto vertex = [&](int i, int j, int k) {
+				std::uint32_t n = (i*h + j)*l + k;
+				if (surface_index[n] == unassigned){
+					surface_index[n] = surface_masses.size();
+					surface_masses.push_back(n);
+				}
+				return surface_index[n];
+			};
+			auto add_triangle = [&](std::uint32_t a, std::uint32_t b, std::uint32_t c, bool flip) {
+				triangles.push_back(a);
+				triangles.push_back(flip ? c : b);
+				triangles.push_back(flip ? b : c);
+			};
+
+			for (int side=0; side<2; side++){
+				bool flip = (side == 1);
+				if (flip && w == 1) break;
+				int i = flip ? w-1 : 0;
+				for (int j=0; j<h-1; j++){
+					for (int k=0; k<l-1; k++){
+						add_triangle(vertex(i,j,k), vertex(i,j,k+1), vertex(i,j+1,k), flip);
+						add_triangle(vertex(i,j,k+1), vertex(i,j+1,k+1), vertex(i,j+1,k), flip);
+					}
+				}
+			}
+			for (int side=0; side<2; side++){
+				bool flip = (side == 1);
+				if (flip && h == 1) break;
+				int j = flip ? h-1 : 0;
+				for (int i=0; i<w-1; i++){
+					for (int k=0; k<l-1; k++){
+						add_triangle(vertex(i,j,k), vertex(i+1,j,k), vertex(i+1,j,k+1), flip);
+						add_triangle(vertex(i,j,k), vertex(i+1,j,k+1), vertex(i,j,k+1), flip);
+					}
+				}
+			}
+			for (int side=0; side<2; side++){
+				bool flip = (side == 1);
+				if (flip && l == 1) break;
+				int k = flip ? l-1 : 0;
+				for (int i=0; i<w-1; i++){
+					for (int j=0; j<h-1; j++){
+						add_triangle(vertex(i,j,k), vertex(i,j+1,k), vertex(i+1,j+1,k), flip);
+						add_triangle(vertex(i,j,k), vertex(i+1,j+1,k), vertex(i+1,j,k), flip);
+					}
+				}
+			}
+
+			jelly_geometry.setIndices(std::move(triangles));
+			jelly_geometry.vertices().resize(surface_masses.size());
+		}
+
+		void CubeOfJellyModel::save(checkpoint::State& state) const {
+			checkpoint::save_masses(masses, springs, state);
+			state.parameters = { g.x, g.y, g.z, width, height, length, ground, r, k };
+		}
+
+		bool CubeOfJellyModel::saved_parameters(const checkpoint::Snapshot& snapshot, CubeOfJellyParameters& parameters) {
+			glm::vec3 g;
+			float width, height, length;
+			std::initializer_list<float*> saved = { &g.x, &g.y, &g.z, &width, &height, &length, &parameters.ground, &parameters.spacing, &parameters.k };
+			if (snapshot.header().parameter_count != saved.size()) {
+				return false;
+			}
+			read_parameters(snapshot, saved);
+			parameters.width = std::uint32_t(width);
+			parameters.height = std::uint32_t(height);
+			parameters.length = std::uint32_t(length);
+			return true;
+		}
+
+		bool CubeOfJellyModel::restore(const checkpoint::Snapshot& snapshot) {
+			std::initializer_list<float*> parameters = { &g.x, &g.y, &g.z, &width, &height, &length, &ground, &r, &k };
+			if (snapshot.header().parameter_count != parameters.size() || !checkpoint::restore_masses(snapshot, masses, springs)) {
+				return false;
+			}
+			read_parameters(snapshot, parameters);
+			save_previous();
+			return true;
+		}
+
+		void CubeOfJellyModel::gather_positions(glm::vec3* positions) const {
+			for (std::size_t n=0; n<masses.size(); n++){
+				positions[n] = masses[n].p;
+			}
+		}
+
+		Surface CubeOfJellyModel::surface() const {
+			return { surface_masses, jelly_geometry.indices() };
 		}
 
 		void CubeOfJellyModel::step(float dt) {
-			for (primatives::Spring& spring : springs){
-				spring.apply_forces();
+			//Each mass only reads its own state below, so the per mass work is split into
+			//one loop per phase without changing the result
+			{
+				PROFILE_SCOPE(SpringForces);
+				for (primatives::Spring& spring : springs){
+					spring.apply_forces();
+				}
 			}
+			{
+				PROFILE_SCOPE(ExternalForces);
+				for (primatives::Mass& mass : masses){
+					float k = 0.05;
+					glm::vec3 f_air = -k*mass.v;
+					mass.f_i += mass.f_g + f_air;
+				}
+			}
+			{
+				PROFILE_SCOPE(Collision);
+				for (primatives::Mass& mass : masses){
+					mass.calc_collision(ground);
+				}
+			}
+			PROFILE_SCOPE(Integration);
 			for (primatives::Mass& mass : masses){
-				float k = 0.05;
-				glm::vec3 f_air = -k*mass.v;
-				mass.f_i += mass.f_g + f_air;
-				mass.calc_collision(ground);
 				mass.integrate(dt);
 				mass.f_i = glm::vec3(0.f);
 			}
@@ -280,92 +601,112 @@ namespace simulation {
 
 		void CubeOfJellyModel::render(const ModelViewContext& view) {
 
-			//Add Mass render
-			jelly_geometry.triangles().clear();
-
-			for (int i=0; i<width; i++){
-				for (int j=0; j<height; j++){
-					for (int k=0; k<length; k++){
-						if (i==0 || i==width-1){
-							if (j<height-1 && k<length-1){
-								jelly_geometry.push_back(cube[i][j][k]->p, cube[i][j][k+1]->p, cube[i][j+1][k]->p);
-								jelly_geometry.push_back(cube[i][j][k+1]->p, cube[i][j+1][k+1]->p, cube[i][j+1][k]->p);
-							}
-						}
-						if (j==0 || j==height-1){
-							if (i<width-1 && k<length-1){
-								jelly_geometry.push_back(cube[i][j][k]->p, cube[i+1][j][k]->p, cube[i+1][j][k+1]->p);
-								jelly_geometry.push_back(cube[i][j][k]->p, cube[i+1][j][k+1]->p, cube[i][j][k+1]->p);
-							}
-						}
-						if (k==0 || k==length-1){
-							if (i<width-1 && j<height-1){
-								jelly_geometry.push_back(cube[i][j][k]->p, cube[i][j+1][k]->p, cube[i+1][j+1][k]->p);
-								jelly_geometry.push_back(cube[i][j][k]->p, cube[i+1][j][k]->p, cube[i+1][j+1][k]->p);
-							}
-						}
-					}
+			{
+				//Gather the surface positions, the connectivity is already uploaded
+				PROFILE_SCOPE(GeometryBuild);
+				std::vector<glm::vec3>& vertices = jelly_geometry.vertices();
+				for (std::size_t n=0; n<surface_masses.size(); n++){
+					std::uint32_t m = surface_masses[n];
+					vertices[n] = glm::lerp(previous_positions[m], masses[m].p, alpha);
 				}
+				givr::style::updateNormals(jelly_geometry, jelly_style);
+			}
+			{
+				PROFILE_SCOPE(BufferUpload);
+				givr::updateRenderable(jelly_geometry, jelly_style, jelly_render);
 			}
-			
-			// Loop over all objects in your simulation/animation
-			jelly_geometry.push_back(cube[0][0][0]->p, cube[0][1][0]->p, cube[1][1][0]->p);
-			jelly_geometry.push_back(cube[0][0][0]->p, cube[1][0][0]->p, cube[1][1][0]->p);
-			givr::updateRenderable(jelly_geometry, jelly_style, jelly_render);
 
 			//Render
+			PROFILE_SCOPE(Draw);
 			givr::style::draw(jelly_render, view);
 			givr::style::draw(floor_render, view);
 		};
 
-		HangingClothModel::HangingClothModel() 
-			: mass_geometry(givr::geometry::Radius(0.2f))
-			, mass_style(givr::style::Colour(1.f, 0.f, 1.f), givr::style::LightPosition(100.f, 100.f, 100.f))
+		HangingClothModel::HangingClothModel(const HangingClothParameters& parameters, BuildProgress* progress)
+			: mass_geometry()
+			, mass_style(givr::style::Colour(1.f, 0.f, 1.f), givr::style::LightPosition(100.f, 100.f, 100.f), givr::style::PointRadius(0.2f))
 			, spring_geometry()
 			, spring_style(givr::style::Colour(1.f, 0.f, 1.f))
 			, cloth_geometry()
 			, cloth_style(givr::style::Colour(1.f, 0.f, 1.f), givr::style::LightPosition(100.f, 100.f, 100.f))
 		{
 			//Link up (Static elements)
-			float size = HangingClothModel::height * HangingClothModel::width;
-			masses.resize(size);
-			for (int i=0; i<size; i++){
-				masses[i].fixed = false;
-				masses[i].mass = 0.01;
-				masses[i].f_g.y = -9.81*masses[i].mass;
+			width = std::max<std::uint32_t>(parameters.width, 2);
+			height = std::max<std::uint32_t>(parameters.height, 2);
+			r = parameters.spacing;
+			k = parameters.k;
+			std::size_t columns = std::size_t(width);
+			std::size_t rows = std::size_t(height);
+			masses.resize(columns*rows);
+			for (primatives::Mass& mass : masses){
+				mass.fixed = false;
+				mass.mass = parameters.mass;
+				mass.f_g.y = -9.81*mass.mass;
+			}
+			if (parameters.pins.empty()) {
+				masses[rows-1].fixed = true;
+				masses[0].fixed = true;
+			}
+			for (const glm::uvec2& pin : parameters.pins){
+				if (pin.x < columns && pin.y < rows) {
+					masses[pin.x*rows + pin.y].fixed = true;
+				}
 			}
-			masses[height-1].fixed = true;
-			masses[0].fixed = true;
 
-			springs.resize(size*12);
-			float n = 0;
 			//Reset to set mass positions, so we can place springs
 			reset();
-			for (int i=0; i<masses.size(); i++){
-				for (int j=0; j<i; j++){
-					float d = glm::length(masses[i].p - masses[j].p);
-					float thresh = glm::length(glm::vec3{0.f,0.f,0.f} - glm::vec3{r,r,0.f});
-					float bend = glm::length(masses[0].p - masses[2].p);
-					//Add springs
-					if (d<=thresh || d==bend){
-						springs[n].mass_a = &masses[i];
-						springs[n].mass_b = &masses[j];
-						springs[n].k = k;
-						springs[n].r = d;
-						springs[n].c = springs[n].critical_damp(springs[n].mass_a->mass)*0.1;
-						n+=1.f;
-					}
-				}
-			}
-			springs.resize(n);
+			//Structural and shear springs join masses within a cell diagonal, bending springs skip
+			//one mass along the width or height
+			const std::vector<LatticeOffset> offsets = {
+				{-2,0,0},
+				{-1,-1,0}, {-1,0,0}, {-1,1,0},
+				{0,-2,0}, {0,-1,0},
+			};
+			link_springs(topology::make_key("HangingCloth", topology_version, width, height, 1, r, masses.size()),
+				masses, springs, k, parameters.damping, progress, offsets, int(width), int(height), 1);
 
 			//Reset Dynamic elements
 			reset();
 
 			// Render
-			mass_render = givr::createInstancedRenderable(mass_geometry, mass_style);
+			index_fixed_masses();
+			spring_geometry.setIndices(spring_indices(masses, springs));
+			// The cloth is a grid of quads over the masses, indexed once here. Both triangles
+			// of a quad share a winding so the vertex normals are consistent.
+			std::vector<std::uint32_t> triangles;
+			int w = width;
+			int h = height;
+			for (int i=0; i<w-1; i++){
+				for (int j=0; j<h-1; j++){
+					std::uint32_t a = i*h + j;
+					std::uint32_t b = i*h + j+1;
+					std::uint32_t c = (i+1)*h + j+1;
+					std::uint32_t d = (i+1)*h + j;
+					triangles.insert(triangles.end(), {a, b, c, a, c, d});
+				}
+			}
+			cloth_geometry.setIndices(std::move(triangles));
+			cloth_geometry.vertices().resize(masses.size());
+		}
+
+		void HangingClothModel::index_fixed_masses() {
+			// Only the fixed masses are drawn, picked out of the shared positions
+			std::vector<std::uint32_t> fixed_masses;
+			for (std::size_t n=0; n<masses.size(); n++){
+				if (masses[n].fixed) {
+					fixed_masses.push_back(std::uint32_t(n));
+				}
+			}
+			mass_geometry.setIndices(std::move(fixed_masses));
+		}
+
+		void HangingClothModel::create_renderables() {
+			mass_render = givr::createRenderable(mass_geometry, mass_style);
 			spring_render = givr::createRenderable(spring_geometry, spring_style);
 			cloth_render = givr::createRenderable(cloth_geometry, cloth_style);
+			givr::shareVertices(mass_render, position_buffer);
+			givr::shareVertices(spring_render, position_buffer);
+			givr::shareVertices(cloth_render, position_buffer);
 		}
 
 		void HangingClothModel::reset() {
@@ -394,16 +735,77 @@ namespace simulation {
 				spring.f_s = { 0.f,0.f,0.f };
 				spring.f_d = { 0.f,0.f,0.f };
 			}
+			save_previous();
+		}
+
+		void HangingClothModel::save_previous() {
+			copy_positions(masses, previous_positions);
+		}
+
+		void HangingClothModel::save(checkpoint::State& state) const {
+			checkpoint::save_masses(masses, springs, state);
+			state.parameters = { g.x, g.y, g.z, width, height, r, k };
+		}
+
+		bool HangingClothModel::saved_parameters(const checkpoint::Snapshot& snapshot, HangingClothParameters& parameters) {
+			glm::vec3 g;
+			float width, height;
+			std::initializer_list<float*> saved = { &g.x, &g.y, &g.z, &width, &height, &parameters.spacing, &parameters.k };
+			if (snapshot.header().parameter_count != saved.size()) {
+				return false;
+			}
+			read_parameters(snapshot, saved);
+			parameters.width = std::uint32_t(width);
+			parameters.height = std::uint32_t(height);
+			return true;
+		}
+
+		bool HangingClothModel::restore(const checkpoint::Snapshot& snapshot) {
+			std::initializer_list<float*> parameters = { &g.x, &g.y, &g.z, &width, &height, &r, &k };
+			if (snapshot.header().parameter_count != parameters.size() || !checkpoint::restore_masses(snapshot, masses, springs)) {
+				return false;
+			}
+			read_parameters(snapshot, parameters);
+			//The checkpoint's masses carry its own pins
+			index_fixed_masses();
+			save_previous();
+			return true;
+		}
+
+		void HangingClothModel::gather_positions(glm::vec3* positions) const {
+			for (std::size_t n=0; n<masses.size(); n++){
+				positions[n] = masses[n].p;
+			}
+		}
+
+		Surface HangingClothModel::surface() const {
+			//The cloth vertices are the masses
+			Surface cloth_surface;
+			cloth_surface.masses.resize(masses.size());
+			for (std::size_t n=0; n<masses.size(); n++){
+				cloth_surface.masses[n] = std::uint32_t(n);
+			}
+			cloth_surface.triangles = cloth_geometry.indices();
+			return cloth_surface;
 		}
 
 		void HangingClothModel::step(float dt) {
-			for (primatives::Spring& spring : springs){
-				spring.apply_forces();
+			{
+				PROFILE_SCOPE(SpringForces);
+				for (primatives::Spring& spring : springs){
+					spring.apply_forces();
+				}
+			}
+			{
+				PROFILE_SCOPE(ExternalForces);
+				for (primatives::Mass& mass : masses){
+					float k = 0.05;
+					glm::vec3 f_air = -k*mass.v;
+					mass.f_i += mass.f_g + f_air;
+				}
 			}
+			PROFILE_SCOPE(Integration);
 			for (primatives::Mass& mass : masses){
-				float k = 0.05;
-				glm::vec3 f_air = -k*mass.v;
-				mass.f_i += mass.f_g + f_air;
 				if (!mass.fixed) {
 					mass.integrate(dt);
 				}
@@ -412,40 +814,25 @@ namespace simulation {
 		}
 
 		void HangingClothModel::render(const ModelViewContext& view) {
-			//Add Mass render
-			for (const primatives::Mass& mass : masses) {
-				if (mass.fixed) {
-					givr::addInstance(mass_render, glm::translate(glm::mat4(1.f), mass.p));
+			{
+				//Gather the positions into the cloth, they are still needed on the CPU for the normals
+				PROFILE_SCOPE(GeometryBuild);
+				std::vector<glm::vec3>& vertices = cloth_geometry.vertices();
+				for (std::size_t n=0; n<masses.size(); n++){
+					vertices[n] = glm::lerp(previous_positions[n], masses[n].p, alpha);
 				}
+				givr::style::updateNormals(cloth_geometry, cloth_style);
 			}
-
-			//Clear and add springs
-			spring_geometry.segments().clear();
-			for (const primatives::Spring& spring : springs) {
-				spring_geometry.push_back(
-					givr::geometry::Line(
-						givr::geometry::Point1(spring.mass_a->p),
-						givr::geometry::Point2(spring.mass_b->p)
-					)
-				);
-			}
-			givr::updateRenderable(spring_geometry, spring_style, spring_render);
-
-			//Add Mass render
-			cloth_geometry.triangles().clear();
-
-			for (int i=0; i<width; i++){
-				for (int j=0; j<height; j++){
-						if (j<height-1 && i<width-1){
-							cloth_geometry.push_back(cloth[i][j]->p, cloth[i][j+1]->p, cloth[i+1][j+1]->p);
-							cloth_geometry.push_back(cloth[i][j]->p, cloth[i+1][j]->p, cloth[i+1][j+1]->p);
-						}
-				}
+			{
+				//Upload the positions once, the masses, springs and cloth all read them. Only the
+				//normals are uploaded with the cloth.
+				PROFILE_SCOPE(BufferUpload);
+				position_buffer.upload(cloth_geometry.vertices());
+				givr::updateRenderable(cloth_geometry, cloth_style, cloth_render);
 			}
-			
-			givr::updateRenderable(cloth_geometry, cloth_style, cloth_render);
 
 			//Render
+			PROFILE_SCOPE(Draw);
 			givr::style::draw(mass_render, view);
 			// givr::style::draw(spring_render, view);
 			givr::style::draw(cloth_render, view);
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <vector>
 #include <givr.h>
 
@@ -10,6 +11,11 @@
 #include <glm/gtx/compatibility.hpp> // lerp
 
 namespace simulation {
+	namespace checkpoint {
+		struct State;
+		class Snapshot;
+	} // namespace checkpoint
+
 	namespace primatives {
 		//Mass points used in all simulations
 		struct Mass {
@@ -109,21 +115,110 @@ namespace simulation {
 	namespace models {
 		//If you want to use a different view, change this and the one in main
 		using ModelViewContext = givr::camera::ViewContext<givr::camera::TurnTableCamera, givr::camera::PerspectiveProjection>;
+		//Fraction of a model's construction done, written by the thread building it
+		using BuildProgress = std::atomic<float>;
+		//What each model is built from, loaded from scene files. The defaults are the original models.
+		struct MassOnSpringParameters {
+			float mass = 0.5f;
+			float k = 15.f;
+			float rest_length = 5.f;
+			//Fraction of critical damping
+			float damping = 0.1f;
+		};
+
+		struct ChainPendulumParameters {
+			std::uint32_t mass_count = 11;
+			float mass = 0.5f;
+			float k = 100.f;
+			float spacing = 1.5f;
+			//Fraction of critical damping
+			float damping = 0.25f;
+			//Indices of the fixed masses
+			std::vector<std::uint32_t> pins = { 0 };
+		};
+
+		struct CubeOfJellyParameters {
+			std::uint32_t width = 7;
+			std::uint32_t height = 4;
+			std::uint32_t length = 4;
+			float mass = 0.1f;
+			float k = 2000.f;
+			float spacing = 1.f;
+			//Fraction of critical damping
+			float damping = 0.25f;
+			//Height of the floor it collides with
+			float ground = -20.f;
+		};
+
+		struct HangingClothParameters {
+			std::uint32_t width = 15;
+			std::uint32_t height = 8;
+			float mass = 0.01f;
+			float k = 100.f;
+			float spacing = 1.f;
+			//Fraction of critical damping
+			float damping = 0.1f;
+			//Fixed masses as (along the width, along the height). Empty fixes the two corners of the first column.
+			std::vector<glm::uvec2> pins;
+		};
+
+		//Triangles over the outside of a model, for exporting
+		struct Surface {
+			//The mass each vertex is
+			std::vector<std::uint32_t> masses;
+			//Three vertices per triangle, counter-clockwise from outside
+			std::vector<std::uint32_t> triangles;
+		};
+
 		// Abstract class used by all models
 		class GenericModel {
 		public:
+			virtual ~GenericModel() = default;
+			//Constructors make no GL calls, so a model can be built on any thread. This creates what
+			//it draws with, on the thread with the GL context, before the first render().
+			virtual void create_renderables() = 0;
 			virtual void reset() = 0;
 			virtual void step(float dt) = 0;
 			virtual void render(const ModelViewContext& view) = 0;
+			//Keeps the current positions as the previous state, call before the last step of a frame
+			virtual void save_previous() = 0;
+			virtual std::size_t mass_count() const = 0;
+			virtual std::size_t spring_count() const = 0;
+			//Fills in everything a checkpoint needs to bring the model back
+			virtual void save(checkpoint::State& state) const = 0;
+			//Restores a checkpoint of the same model type, false if it does not fit this model
+			virtual bool restore(const checkpoint::Snapshot& snapshot) = 0;
+			//Copies the current position of each of the mass_count() masses
+			virtual void gather_positions(glm::vec3* positions) const = 0;
+			//Empty for models without a surface
+			virtual Surface surface() const { return Surface(); }
+
+			//Steps and keeps count of the simulated time
+			virtual void advance(float dt) {
+				step(dt);
+				time += dt;
+			}
+
+			//Simulated seconds since the last reset
+			double time = 0.0;
+			//How far the display is between the previous and the current state (1 shows the current)
+			float alpha = 1.f;
 		};
 
 		//Model constructing a single spring
 		class MassOnSpringModel : public GenericModel {
 		public:
-			MassOnSpringModel();
+			explicit MassOnSpringModel(const MassOnSpringParameters& parameters = MassOnSpringParameters());
+			void create_renderables();
 			void reset();
 			void step(float dt);
 			void render(const ModelViewContext& view);
+			void save_previous();
+			void save(checkpoint::State& state) const;
+			bool restore(const checkpoint::Snapshot& snapshot);
+			void gather_positions(glm::vec3* positions) const;
+			std::size_t mass_count() const { return 2; }
+			std::size_t spring_count() const { return 1; }
 
 			//Simulation Constants (you can re-assign values here from imgui)
 			glm::vec3 g = { 0.f, -9.81f, 0.f };
@@ -134,24 +229,37 @@ namespace simulation {
 			primatives::Mass mass_b;
 			primatives::Spring spring;
 			bool released = false;
+			//Positions before the last step, blended with the current ones by alpha
+			std::vector<glm::vec3> previous_positions;
 
 			//Render
-			givr::geometry::Sphere mass_geometry; 
-			givr::style::Phong mass_style;
-			givr::InstancedRenderContext<givr::geometry::Sphere, givr::style::Phong> mass_render;
+			//Mass positions, uploaded once a frame and shared by the masses and the spring
+			std::vector<glm::vec3> positions;
+			givr::SharedVertexBuffer position_buffer;
 
-			givr::geometry::MultiLine spring_geometry;
+			givr::geometry::PointCloud mass_geometry;
+			givr::style::SphereImpostor mass_style;
+			givr::RenderContext<givr::geometry::PointCloud, givr::style::SphereImpostor> mass_render;
+
+			givr::geometry::SpringNetwork spring_geometry;
 			givr::style::LineStyle spring_style;
-			givr::RenderContext<givr::geometry::MultiLine, givr::style::LineStyle> spring_render;
+			givr::RenderContext<givr::geometry::SpringNetwork, givr::style::LineStyle> spring_render;
 		};
 
 		//Model constructing a chain of springs
 		class ChainPendulumModel : public GenericModel {
 		public:
-			ChainPendulumModel();
+			explicit ChainPendulumModel(const ChainPendulumParameters& parameters = ChainPendulumParameters());
+			void create_renderables();
 			void reset();
 			void step(float dt);
 			void render(const ModelViewContext& view);
+			void save_previous();
+			void save(checkpoint::State& state) const;
+			bool restore(const checkpoint::Snapshot& snapshot);
+			void gather_positions(glm::vec3* positions) const;
+			std::size_t mass_count() const { return masses.size(); }
+			std::size_t spring_count() const { return springs.size(); }
 
 			//Simulation Constants (you can re-assign values here from imgui)
 			glm::vec3 g = { 0.f, -9.81f, 0.f };
@@ -162,23 +270,42 @@ namespace simulation {
 			//Simulation Parts
 			std::vector<primatives::Mass> masses;
 			std::vector<primatives::Spring> springs;
+			//Distance between the masses when reset
+			float spacing = 1.5f;
+			//Positions before the last step, blended with the current ones by alpha
+			std::vector<glm::vec3> previous_positions;
 
 			//Render
-			givr::geometry::Sphere mass_geometry;
-			givr::style::Phong mass_style;
-			givr::InstancedRenderContext<givr::geometry::Sphere, givr::style::Phong> mass_render;
+			//Mass positions, uploaded once a frame and shared by the masses and the springs
+			std::vector<glm::vec3> positions;
+			givr::SharedVertexBuffer position_buffer;
+
+			givr::geometry::PointCloud mass_geometry;
+			givr::style::SphereImpostor mass_style;
+			givr::RenderContext<givr::geometry::PointCloud, givr::style::SphereImpostor> mass_render;
 
-			givr::geometry::MultiLine spring_geometry;
+			givr::geometry::SpringNetwork spring_geometry;
 			givr::style::LineStyle spring_style;
-			givr::RenderContext<givr::geometry::MultiLine, givr::style::LineStyle> spring_render;
+			givr::RenderContext<givr::geometry::SpringNetwork, givr::style::LineStyle> spring_render;
 		};
 
 		class CubeOfJellyModel : public GenericModel {
 			public:
-				CubeOfJellyModel();
+				explicit CubeOfJellyModel(const CubeOfJellyParameters& parameters = CubeOfJellyParameters(), BuildProgress* progress = nullptr);
+				//The size, spacing, stiffness and ground a checkpoint of this model was built with, false if
+				//it does not hold them
+				static bool saved_parameters(const checkpoint::Snapshot& snapshot, CubeOfJellyParameters& parameters);
+				void create_renderables();
 				void reset();
 				void step(float dt);
 				void render(const ModelViewContext& view);
+				void save_previous();
+				void save(checkpoint::State& state) const;
+				bool restore(const checkpoint::Snapshot& snapshot);
+				void gather_positions(glm::vec3* positions) const;
+				Surface surface() const;
+				std::size_t mass_count() const { return masses.size(); }
+				std::size_t spring_count() const { return springs.size(); }
 
 				//Simulation Constants (you can re-assign values here from imgui)
 				glm::vec3 g = { 0.f, -9.81f, 0.f };
@@ -194,11 +321,17 @@ namespace simulation {
 				float ground = -20;
 				float r = 1;
 				float k = 2000;
+				// Masses on the outside of the cube, in the order they are drawn
+				std::vector<std::uint32_t> surface_masses;
+				//Positions before the last step, blended with the current ones by alpha
+				std::vector<glm::vec3> previous_positions;
+
+				void buildSurface();
 
 				//Render
-				givr::geometry::TriangleSoup jelly_geometry;
+				givr::geometry::SurfaceMesh jelly_geometry;
 				givr::style::Phong jelly_style;
-				givr::RenderContext<givr::geometry::TriangleSoup, givr::style::Phong> jelly_render;
+				givr::RenderContext<givr::geometry::SurfaceMesh, givr::style::Phong> jelly_render;
 
 				givr::geometry::TriangleSoup floor_geometry;
 				givr::style::Phong floor_style;
@@ -206,10 +339,21 @@ namespace simulation {
 		}; //should be at least 4 in each direction
 		class HangingClothModel : public GenericModel {
 			public:
-				HangingClothModel();
+				explicit HangingClothModel(const HangingClothParameters& parameters = HangingClothParameters(), BuildProgress* progress = nullptr);
+				//The size, spacing and stiffness a checkpoint of this model was built with, false if it does
+				//not hold them
+				static bool saved_parameters(const checkpoint::Snapshot& snapshot, HangingClothParameters& parameters);
+				void create_renderables();
 				void reset();
 				void step(float dt);
 				void render(const ModelViewContext& view);
+				void save_previous();
+				void save(checkpoint::State& state) const;
+				bool restore(const checkpoint::Snapshot& snapshot);
+				void gather_positions(glm::vec3* positions) const;
+				Surface surface() const;
+				std::size_t mass_count() const { return masses.size(); }
+				std::size_t spring_count() const { return springs.size(); }
 
 				//Simulation Constants (you can re-assign values here from imgui)
 				glm::vec3 g = { 0.f, -9.81f, 0.f };
@@ -217,25 +361,34 @@ namespace simulation {
 				float height = 8;
 
 			private:
+				//Points the drawn masses at the fixed ones
+				void index_fixed_masses();
+
 				//Simulation Parts
 				std::vector<std::vector<primatives::Mass*>> cloth;
 				std::vector<primatives::Mass> masses;
 				std::vector<primatives::Spring> springs;
 				float r = 1;
 				float k = 100;
+				//Positions before the last step, blended with the current ones by alpha
+				std::vector<glm::vec3> previous_positions;
 
 				//Render
-				givr::geometry::Sphere mass_geometry; 
-				givr::style::Phong mass_style;
-				givr::InstancedRenderContext<givr::geometry::Sphere, givr::style::Phong> mass_render;
+				//Mass positions (the cloth vertices), uploaded once a frame and shared by the
+				//fixed masses, the springs and the cloth
+				givr::SharedVertexBuffer position_buffer;
+
+				givr::geometry::PointCloud mass_geometry;
+				givr::style::SphereImpostor mass_style;
+				givr::RenderContext<givr::geometry::PointCloud, givr::style::SphereImpostor> mass_render;
 
-				givr::geometry::MultiLine spring_geometry;
+				givr::geometry::SpringNetwork spring_geometry;
 				givr::style::LineStyle spring_style;
-				givr::RenderContext<givr::geometry::MultiLine, givr::style::LineStyle> spring_render;
+				givr::RenderContext<givr::geometry::SpringNetwork, givr::style::LineStyle> spring_render;
 
-				givr::geometry::TriangleSoup cloth_geometry;
+				givr::geometry::SurfaceMesh cloth_geometry;
 				givr::style::Phong cloth_style;
-				givr::RenderContext<givr::geometry::TriangleSoup, givr::style::Phong> cloth_render;
+				givr::RenderContext<givr::geometry::SurfaceMesh, givr::style::Phong> cloth_render;
 		}; //should be at least 8 in each direction
 
 	} // namespace models
@@ -0,0 +1,188 @@
+#include "playback.hpp"
+#include "checkpoint.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace simulation {
+	namespace models {
+		PlaybackModel::PlaybackModel()
+			: mass_geometry()
+			, mass_style(givr::style::Colour(1.f, 0.f, 1.f), givr::style::LightPosition(100.f, 100.f, 100.f), givr::style::PointRadius(0.2f))
+		{
+			std::memset(&header, 0, sizeof(header));
+			std::memset(&footer, 0, sizeof(footer));
+		}
+
+		void PlaybackModel::create_renderables() {
+			mass_render = givr::createRenderable(mass_geometry, mass_style);
+			givr::shareVertices(mass_render, position_buffer);
+		}
+
+		bool PlaybackModel::open(const std::string& path) {
+			open_error.clear();
+			index.clear();
+			std::memset(&footer, 0, sizeof(footer));
+			if (!file.open(path)) {
+				open_error = "cannot open " + path;
+				return false;
+			}
+			if (file.size() < sizeof(header) + sizeof(footer)) {
+				open_error = path + " is not a trajectory";
+				return false;
+			}
+			std::memcpy(&header, file.data(), sizeof(header));
+			std::memcpy(&footer, file.data() + file.size() - sizeof(footer), sizeof(footer));
+			if (std::memcmp(header.magic, trajectory::file_magic, sizeof(header.magic)) != 0 || header.version != trajectory::version) {
+				open_error = path + " is not a trajectory of this version";
+			} else if (std::memcmp(footer.magic, trajectory::footer_magic, sizeof(footer.magic)) != 0) {
+				open_error = path + " has no index, the recording was not finished";
+			} else if (footer.index_offset > file.size() - sizeof(footer)
+				|| file.size() - sizeof(footer) - footer.index_offset != std::uint64_t(footer.chunk_count) * sizeof(trajectory::ChunkEntry)) {
+				open_error = path + " has a damaged index";
+			} else if (footer.frame_count == 0 || header.mass_count == 0) {
+				open_error = path + " has no frames";
+			}
+			if (open_error.empty()) {
+				index.resize(footer.chunk_count);
+				std::memcpy(index.data(), file.data() + footer.index_offset, index.size() * sizeof(trajectory::ChunkEntry));
+				std::uint64_t frames = 0;
+				for (const trajectory::ChunkEntry& entry : index) {
+					if (entry.first_frame != frames || entry.frame_count == 0
+						|| entry.offset < sizeof(header) || entry.offset > footer.index_offset || entry.size > footer.index_offset - entry.offset) {
+						open_error = path + " has a damaged index";
+						break;
+					}
+					frames += entry.frame_count;
+				}
+				if (open_error.empty() && frames != footer.frame_count) {
+					open_error = path + " has a damaged index";
+				}
+				//A frame is its time and at least a byte for each coordinate, so a damaged mass count
+				//is caught before the decoding buffers are sized by it
+				if (open_error.empty() && index[0].size < sizeof(double) + 3 * std::uint64_t(header.mass_count)) {
+					open_error = path + " has fewer positions than masses";
+				}
+			}
+			if (!open_error.empty()) {
+				index.clear();
+				std::memset(&footer, 0, sizeof(footer));
+				file.close();
+				return false;
+			}
+
+			quantized.assign(3 * header.mass_count, 0);
+			current.assign(header.mass_count, glm::vec3(0.f));
+			positions.assign(header.mass_count, glm::vec3(0.f));
+
+			//The playback rate follows the recording, from the time of its last frame
+			seek(frame_count() - 1);
+			double last_time = time;
+			seek(0);
+			recorded_dt = frame_count() > 1 ? float((last_time - time) / (frame_count() - 1)) : header.dt;
+			//Frames out of order (from an older recording kept past a reset) are played at its step
+			if (!(recorded_dt > 0.f)) {
+				recorded_dt = header.dt;
+			}
+			save_previous();
+			return true;
+		}
+
+		void PlaybackModel::reset() {
+			seek(0);
+			save_previous();
+		}
+
+		bool PlaybackModel::decode_next() {
+			if (chunk_frame == index[chunk].frame_count) {
+				if (chunk + 1 == index.size()) {
+					return false;
+				}
+				chunk++;
+				chunk_frame = 0;
+			}
+			const trajectory::ChunkEntry& entry = index[chunk];
+			if (chunk_frame == 0) {
+				//Every chunk starts from zero
+				bytes = file.data() + entry.offset;
+				std::fill(quantized.begin(), quantized.end(), 0);
+			}
+			const unsigned char* end = file.data() + entry.offset + entry.size;
+			if (end - bytes < std::ptrdiff_t(sizeof(double))) {
+				return false;
+			}
+			std::memcpy(&time, bytes, sizeof(double));
+			bytes += sizeof(double);
+			for (std::int64_t& value : quantized) {
+				std::uint64_t change;
+				if (!trajectory::get_varint(bytes, end, change)) {
+					return false;
+				}
+				value += trajectory::unzigzag(change);
+			}
+			double precision = header.precision;
+			for (std::size_t m = 0; m < current.size(); m++) {
+				current[m] = glm::vec3(quantized[3 * m] * precision, quantized[3 * m + 1] * precision, quantized[3 * m + 2] * precision);
+			}
+			cursor = entry.first_frame + chunk_frame;
+			chunk_frame++;
+			return true;
+		}
+
+		void PlaybackModel::seek(std::size_t frame) {
+			if (index.empty()) {
+				return;
+			}
+			frame = std::min(frame, frame_count() - 1);
+			//The last chunk starting at or before the frame
+			std::vector<trajectory::ChunkEntry>::const_iterator found = std::upper_bound(index.begin(), index.end(), frame,
+				[](std::size_t f, const trajectory::ChunkEntry& entry) { return f < entry.first_frame; });
+			chunk = std::size_t(found - index.begin()) - 1;
+			chunk_frame = 0;
+			for (std::size_t n = index[chunk].first_frame; n <= frame; n++) {
+				if (!decode_next()) {
+					break;
+				}
+			}
+		}
+
+		void PlaybackModel::step(float) {
+			if (!index.empty() && cursor + 1 < frame_count()) {
+				decode_next();
+			}
+		}
+
+		void PlaybackModel::save_previous() {
+			previous_positions = current;
+		}
+
+		void PlaybackModel::save(checkpoint::State& state) const {
+			state = checkpoint::State();
+		}
+
+		bool PlaybackModel::restore(const checkpoint::Snapshot&) {
+			return false;
+		}
+
+		void PlaybackModel::gather_positions(glm::vec3* positions) const {
+			std::copy(current.begin(), current.end(), positions);
+		}
+
+		void PlaybackModel::render(const ModelViewContext& view) {
+			{
+				PROFILE_SCOPE(GeometryBuild);
+				for (std::size_t n=0; n<current.size(); n++){
+					positions[n] = glm::lerp(previous_positions[n], current[n], alpha);
+				}
+			}
+			{
+				PROFILE_SCOPE(BufferUpload);
+				position_buffer.upload(positions);
+			}
+
+			PROFILE_SCOPE(Draw);
+			givr::style::draw(mass_render, view);
+		}
+	} // namespace models
+} // namespace simulation
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "mapped_file.hpp"
+#include "models.hpp"
+#include "trajectory.hpp"
+
+namespace simulation {
+	namespace models {
+		//Replays a recorded trajectory (see trajectory::Recorder) as its masses. The file is
+		//mapped rather than read, and a frame is only decoded when it is shown: stepping decodes
+		//the next frame from the last, and seeking finds the chunk in the index and decodes from
+		//its start. Neither depends on the length of the recording.
+		class PlaybackModel : public GenericModel {
+		public:
+			PlaybackModel();
+			//False (with error() saying why) if the file is not a complete trajectory
+			bool open(const std::string& path);
+			const std::string& error() const { return open_error; }
+
+			void create_renderables();
+			//Back to the first frame
+			void reset();
+			//Moves on one frame, dt is not used
+			void step(float dt);
+			//The time is the recorded time of the frame
+			void advance(float dt) { step(dt); }
+			void render(const ModelViewContext& view);
+			void save_previous();
+			//Trajectories have no state to checkpoint, restoring always fails
+			void save(checkpoint::State& state) const;
+			bool restore(const checkpoint::Snapshot& snapshot);
+			void gather_positions(glm::vec3* positions) const;
+			std::size_t mass_count() const { return current.size(); }
+			std::size_t spring_count() const { return 0; }
+
+			void seek(std::size_t frame);
+			std::size_t frame() const { return cursor; }
+			std::size_t frame_count() const { return footer.frame_count; }
+			//imgui_panel::ModelType of the recorded model
+			std::uint32_t model_type() const { return header.model_type; }
+			//Average time between the recorded frames
+			float frame_dt() const { return recorded_dt; }
+
+		private:
+			bool decode_next();
+
+			MappedFile file;
+			std::string open_error;
+			//Copied out of the file, the index is not aligned
+			trajectory::FileHeader header;
+			trajectory::Footer footer;
+			std::vector<trajectory::ChunkEntry> index;
+			float recorded_dt = 0.f;
+
+			//Decoding position, the next frame is read from bytes
+			std::size_t cursor = 0;
+			std::size_t chunk = 0;
+			std::size_t chunk_frame = 0;
+			const unsigned char* bytes = nullptr;
+			std::vector<std::int64_t> quantized;
+
+			std::vector<glm::vec3> current;
+			//Positions before the last step, blended with the current ones by alpha
+			std::vector<glm::vec3> previous_positions;
+
+			//Render
+			std::vector<glm::vec3> positions;
+			givr::SharedVertexBuffer position_buffer;
+
+			givr::geometry::PointCloud mass_geometry;
+			givr::style::SphereImpostor mass_style;
+			givr::RenderContext<givr::geometry::PointCloud, givr::style::SphereImpostor> mass_render;
+		};
+	} // namespace models
+} // namespace simulation
@@ -0,0 +1,185 @@
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+namespace profiler {
+	namespace {
+		//Rings are never freed. A thread that exits hands its ring (and any samples not yet
+		//collected) on to the next new thread. Threads past the limit are not recorded.
+		constexpr std::size_t max_threads = 64;
+		std::array<std::atomic<SampleRing*>, max_threads> rings{};
+		std::atomic<std::size_t> ring_count{ 0 };
+		std::atomic<std::uint64_t> dropped{ 0 };
+
+		const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+		//Only touched by collect() and the readers on the main thread
+		std::array<std::array<float, history_length>, phase_count> history;
+		std::array<std::array<std::uint32_t, history_length>, phase_count> allocation_history;
+		std::vector<Sample> trace_batch;
+		std::size_t history_next = 0;
+		std::size_t history_count = 0;
+
+		std::mutex ring_mutex;
+
+		//A thread's claim on a ring, released when the thread exits
+		struct RingClaim {
+			SampleRing* ring = nullptr;
+			std::uint8_t index = 0;
+
+			RingClaim() {
+				//Only taken once per thread
+				std::lock_guard<std::mutex> lock(ring_mutex);
+				std::size_t count = ring_count.load(std::memory_order_relaxed);
+				for (std::size_t n = 0; n < count; n++) {
+					SampleRing* free_ring = rings[n].load(std::memory_order_relaxed);
+					if (!free_ring->in_use.load(std::memory_order_acquire)) {
+						claim(free_ring, n);
+						return;
+					}
+				}
+				if (count < max_threads) {
+					SampleRing* new_ring = new SampleRing();
+					claim(new_ring, count);
+					rings[count].store(new_ring, std::memory_order_release);
+					ring_count.store(count + 1, std::memory_order_release);
+				}
+			}
+			~RingClaim() {
+				if (ring) {
+					ring->in_use.store(false, std::memory_order_release);
+				}
+			}
+			void claim(SampleRing* claimed, std::size_t n) {
+				claimed->in_use.store(true, std::memory_order_relaxed);
+				ring = claimed;
+				index = std::uint8_t(n);
+			}
+		};
+
+		SampleRing* thread_ring(std::uint8_t& thread) {
+			thread_local RingClaim claim;
+			thread = claim.index;
+			return claim.ring;
+		}
+	}
+
+	const char* phase_name(Phase phase) {
+		switch (phase) {
+		case Phase::SpringForces: return "Spring Forces";
+		case Phase::ExternalForces: return "External Forces";
+		case Phase::Collision: return "Collision";
+		case Phase::Integration: return "Integration";
+		case Phase::GeometryBuild: return "Geometry Build";
+		case Phase::BufferUpload: return "Buffer Upload";
+		case Phase::Draw: return "Draw";
+		default: return "";
+		}
+	}
+
+	bool SampleRing::push(const Sample& sample) {
+		std::size_t h = head.load(std::memory_order_relaxed);
+		if (h - tail.load(std::memory_order_acquire) == capacity) {
+			return false;
+		}
+		samples[h % capacity] = sample;
+		head.store(h + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool SampleRing::pop(Sample& sample) {
+		std::size_t t = tail.load(std::memory_order_relaxed);
+		if (t == head.load(std::memory_order_acquire)) {
+			return false;
+		}
+		sample = samples[t % capacity];
+		tail.store(t + 1, std::memory_order_release);
+		return true;
+	}
+
+	std::uint64_t now_ns() {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+	}
+
+	void record(Phase phase, std::uint64_t start_ns, std::uint64_t end_ns, std::uint32_t allocations) {
+		std::uint8_t thread = 0;
+		SampleRing* ring = thread_ring(thread);
+		if (!ring || !ring->push({ start_ns, end_ns, phase, thread, allocations })) {
+			dropped.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	void collect() {
+		std::array<std::uint64_t, phase_count> totals{};
+		std::array<std::uint32_t, phase_count> allocations{};
+		bool trace = tracing();
+		std::size_t count = ring_count.load(std::memory_order_acquire);
+		for (std::size_t n = 0; n < count; n++) {
+			SampleRing* ring = rings[n].load(std::memory_order_acquire);
+			if (!ring) {
+				continue;
+			}
+			Sample sample;
+			while (ring->pop(sample)) {
+				totals[std::size_t(sample.phase)] += sample.end_ns - sample.start_ns;
+				allocations[std::size_t(sample.phase)] += sample.allocations;
+				if (trace) {
+					trace_batch.push_back(sample);
+				}
+			}
+		}
+		if (!trace_batch.empty()) {
+			trace_samples(trace_batch.data(), trace_batch.size());
+			trace_batch.clear();
+		}
+
+		for (std::size_t p = 0; p < phase_count; p++) {
+			history[p][history_next] = totals[p] * 1e-6f;
+			allocation_history[p][history_next] = allocations[p];
+		}
+		history_next = (history_next + 1) % history_length;
+		history_count = std::min(history_count + 1, history_length);
+	}
+
+	float frame_ms(Phase phase, std::size_t frames_ago) {
+		std::size_t n = (history_next + history_length - 1 - frames_ago) % history_length;
+		return history[std::size_t(phase)][n];
+	}
+
+	std::uint32_t frame_allocations(Phase phase, std::size_t frames_ago) {
+		std::size_t n = (history_next + history_length - 1 - frames_ago) % history_length;
+		return allocation_history[std::size_t(phase)][n];
+	}
+
+	std::size_t history_size() {
+		return history_count;
+	}
+
+	Summary summarize(Phase phase) {
+		Summary summary;
+		if (history_count == 0) {
+			return summary;
+		}
+		std::array<float, history_length> sorted;
+		for (std::size_t n = 0; n < history_count; n++) {
+			sorted[n] = frame_ms(phase, n);
+		}
+		std::sort(sorted.begin(), sorted.begin() + history_count);
+		float total = 0.f;
+		for (std::size_t n = 0; n < history_count; n++) {
+			total += sorted[n];
+			summary.max_allocations = std::max(summary.max_allocations, frame_allocations(phase, n));
+		}
+		summary.min_ms = sorted[0];
+		summary.avg_ms = total / history_count;
+		summary.p99_ms = sorted[std::min(history_count - 1, history_count * 99 / 100)];
+		return summary;
+	}
+
+	std::uint64_t dropped_samples() {
+		return dropped.load(std::memory_order_relaxed);
+	}
+} // namespace profiler
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "allocation_tracker.hpp"
+
+//Scoped CPU timing of the phases of a frame. Each thread records into its own
+//lock-free ring, and the main thread drains them once a frame with collect().
+//With SIMULATION_PROFILER undefined (the ENABLE_PROFILER CMake option) the
+//PROFILE_SCOPE macro compiles to nothing.
+namespace profiler {
+	enum class Phase : std::uint8_t {
+		SpringForces,
+		ExternalForces,
+		Collision,
+		Integration,
+		GeometryBuild,
+		BufferUpload,
+		Draw,
+		Count
+	};
+	constexpr std::size_t phase_count = std::size_t(Phase::Count);
+
+	const char* phase_name(Phase phase);
+
+	//One timed scope, in nanoseconds since the profiler started
+	struct Sample {
+		std::uint64_t start_ns;
+		std::uint64_t end_ns;
+		Phase phase;
+		std::uint8_t thread;
+		//Heap allocations made in the scope, when allocation tracking is built in
+		std::uint32_t allocations;
+	};
+
+	//Fixed size ring with one producer (the recording thread) and one consumer (collect)
+	class SampleRing {
+	public:
+		static constexpr std::size_t capacity = 4096;
+
+		//Drops the sample when the ring is full
+		bool push(const Sample& sample);
+		bool pop(Sample& sample);
+
+		//Claimed by a thread for its lifetime, then reused by a later thread
+		std::atomic<bool> in_use{ false };
+
+	private:
+		std::array<Sample, capacity> samples;
+		alignas(64) std::atomic<std::size_t> head{ 0 };
+		alignas(64) std::atomic<std::size_t> tail{ 0 };
+	};
+
+	std::uint64_t now_ns();
+	void record(Phase phase, std::uint64_t start_ns, std::uint64_t end_ns, std::uint32_t allocations);
+
+	class ScopedTimer {
+	public:
+		explicit ScopedTimer(Phase phase) : phase(phase), start_ns(now_ns()) {}
+		~ScopedTimer() { record(phase, start_ns, now_ns(), std::uint32_t(allocations.counts().allocations)); }
+
+		ScopedTimer(const ScopedTimer&) = delete;
+		ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+	private:
+		Phase phase;
+		std::uint64_t start_ns;
+		allocation::Scope allocations;
+	};
+
+	//Drains every thread's ring into the current frame and closes it. Main thread only.
+	void collect();
+
+	constexpr std::size_t history_length = 240;
+
+	//Milliseconds spent in a phase during a completed frame, 0 being the most recent
+	float frame_ms(Phase phase, std::size_t frames_ago);
+	std::uint32_t frame_allocations(Phase phase, std::size_t frames_ago);
+	std::size_t history_size();
+
+	//Over the frames in the history
+	struct Summary {
+		float min_ms = 0.f;
+		float avg_ms = 0.f;
+		float p99_ms = 0.f;
+		std::uint32_t max_allocations = 0;
+	};
+	Summary summarize(Phase phase);
+
+	//Samples lost to full rings or too many threads since the start
+	std::uint64_t dropped_samples();
+
+	//Records every collected sample to a Chrome trace-event JSON file (for about://tracing or
+	//Perfetto). The samples are handed over once a frame by collect() and written on a
+	//background thread.
+	bool start_trace(const std::string& path);
+	void stop_trace();
+	bool tracing();
+	//Called by collect() with the frame's samples
+	void trace_samples(const Sample* samples, std::size_t count);
+} // namespace profiler
+
+#ifdef SIMULATION_PROFILER
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(phase) ::profiler::ScopedTimer PROFILE_CONCAT(profile_scope_, __LINE__)(::profiler::Phase::phase)
+#else
+#define PROFILE_SCOPE(phase) do {} while (0)
+#endif
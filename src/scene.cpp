@@ -0,0 +1,464 @@
+#include "scene.hpp"
+#include "json_reader.hpp"
+#include "checkpoint.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <new>
+
+namespace simulation {
+	namespace scene {
+		namespace {
+			struct TypeName {
+				imgui_panel::ModelType type;
+				const char* name;
+			};
+			const TypeName type_names[] = {
+				{ imgui_panel::ModelType::MassOnSpring, "MassOnSpring" },
+				{ imgui_panel::ModelType::ChainPendulum, "ChainPendulum" },
+				{ imgui_panel::ModelType::CubeOfJelly, "CubeOfJelly" },
+				{ imgui_panel::ModelType::HangingCloth, "HangingCloth" },
+			};
+
+			bool read_float(json::Reader& reader, float& value) {
+				double number;
+				if (!reader.read_number(number)) {
+					return false;
+				}
+				value = float(number);
+				return true;
+			}
+
+			bool read_positive(json::Reader& reader, float& value, const std::string& key) {
+				if (!read_float(reader, value)) {
+					return false;
+				}
+				if (!(value > 0.f)) {
+					reader.fail(key + " must be positive");
+					return false;
+				}
+				return true;
+			}
+
+			bool read_non_negative(json::Reader& reader, float& value, const std::string& key) {
+				if (!read_float(reader, value)) {
+					return false;
+				}
+				if (!(value >= 0.f)) {
+					reader.fail(key + " must not be negative");
+					return false;
+				}
+				return true;
+			}
+
+			bool read_count(json::Reader& reader, std::uint32_t& value) {
+				double number;
+				if (!reader.read_number(number)) {
+					return false;
+				}
+				if (number < 0 || number > 1e6 || number != double(std::uint32_t(number))) {
+					reader.fail("expected a whole number");
+					return false;
+				}
+				value = std::uint32_t(number);
+				return true;
+			}
+
+			//A fixed size array of counts
+			bool read_counts(json::Reader& reader, std::uint32_t* values, std::size_t count, const std::string& key) {
+				if (!reader.begin_array()) {
+					return false;
+				}
+				std::size_t n = 0;
+				while (reader.next_element()) {
+					if (n == count) {
+						reader.fail(key + " has more than " + std::to_string(count) + " values");
+						return false;
+					}
+					if (!read_count(reader, values[n++])) {
+						return false;
+					}
+				}
+				if (reader.ok() && n != count) {
+					reader.fail(key + " needs " + std::to_string(count) + " values");
+				}
+				return reader.ok();
+			}
+
+			bool read_solver(json::Reader& reader, Scene& scene) {
+				std::string key;
+				reader.begin_object();
+				while (reader.next_key(key)) {
+					if (key == "dt") {
+						read_positive(reader, scene.dt, key);
+					} else if (key == "iterations_per_frame") {
+						std::uint32_t iterations;
+						if (read_count(reader, iterations)) {
+							scene.iterations_per_frame = int(std::min<std::uint32_t>(std::max<std::uint32_t>(iterations, 1), 100));
+						}
+					} else {
+						reader.fail("unknown solver setting " + key);
+					}
+				}
+				return reader.ok();
+			}
+
+			//Parameters every body has
+			bool read_material(json::Reader& reader, const std::string& key, float& mass, float& k, float& damping, bool& known) {
+				known = true;
+				if (key == "mass") {
+					return read_positive(reader, mass, key);
+				}
+				if (key == "k") {
+					return read_positive(reader, k, key);
+				}
+				if (key == "damping") {
+					return read_non_negative(reader, damping, key);
+				}
+				known = false;
+				return true;
+			}
+
+			bool read_colliders(json::Reader& reader, models::CubeOfJellyParameters& jelly) {
+				reader.begin_array();
+				while (reader.next_element()) {
+					std::string key;
+					std::string type;
+					reader.begin_object();
+					while (reader.next_key(key)) {
+						if (key == "type") {
+							reader.read_string(type);
+							if (reader.ok() && type != "ground") {
+								reader.fail("the only collider is the ground");
+							}
+						} else if (key == "height") {
+							read_float(reader, jelly.ground);
+						} else {
+							reader.fail("unknown collider setting " + key);
+						}
+					}
+				}
+				return reader.ok();
+			}
+
+			bool read_body(json::Reader& reader, Scene& scene) {
+				std::string key;
+				reader.begin_object();
+				//The type decides which keys follow, so it has to be known first
+				if (!reader.next_key(key) || key != "type") {
+					reader.fail("the body's type has to come first");
+					return false;
+				}
+				std::string type;
+				if (!reader.read_string(type)) {
+					return false;
+				}
+				const TypeName* found = std::find_if(std::begin(type_names), std::end(type_names),
+					[&](const TypeName& entry) { return type == entry.name; });
+				if (found == std::end(type_names)) {
+					reader.fail("unknown body type " + type);
+					return false;
+				}
+				scene.type = found->type;
+
+				while (reader.next_key(key)) {
+					bool known = true;
+					switch (scene.type) {
+					case imgui_panel::ModelType::MassOnSpring: {
+						models::MassOnSpringParameters& p = scene.mass_on_spring;
+						if (!read_material(reader, key, p.mass, p.k, p.damping, known) || known) {
+							break;
+						}
+						known = key == "rest_length";
+						if (known) {
+							read_positive(reader, p.rest_length, key);
+						}
+					} break;
+					case imgui_panel::ModelType::ChainPendulum: {
+						models::ChainPendulumParameters& p = scene.chain_pendulum;
+						if (!read_material(reader, key, p.mass, p.k, p.damping, known) || known) {
+							break;
+						}
+						known = true;
+						if (key == "masses") {
+							if (read_count(reader, p.mass_count) && p.mass_count < 2) {
+								reader.fail("a chain needs at least 2 masses");
+							}
+						} else if (key == "spacing") {
+							read_positive(reader, p.spacing, key);
+						} else if (key == "pins") {
+							p.pins.clear();
+							reader.begin_array();
+							while (reader.next_element()) {
+								std::uint32_t pin;
+								if (read_count(reader, pin)) {
+									p.pins.push_back(pin);
+								}
+							}
+						} else {
+							known = false;
+						}
+					} break;
+					case imgui_panel::ModelType::CubeOfJelly: {
+						models::CubeOfJellyParameters& p = scene.cube_of_jelly;
+						if (!read_material(reader, key, p.mass, p.k, p.damping, known) || known) {
+							break;
+						}
+						known = true;
+						if (key == "grid") {
+							std::uint32_t grid[3];
+							if (read_counts(reader, grid, 3, key)) {
+								p.width = grid[0];
+								p.height = grid[1];
+								p.length = grid[2];
+							}
+						} else if (key == "spacing") {
+							read_positive(reader, p.spacing, key);
+						} else if (key == "colliders") {
+							read_colliders(reader, p);
+						} else {
+							known = false;
+						}
+					} break;
+					case imgui_panel::ModelType::HangingCloth: {
+						models::HangingClothParameters& p = scene.hanging_cloth;
+						if (!read_material(reader, key, p.mass, p.k, p.damping, known) || known) {
+							break;
+						}
+						known = true;
+						if (key == "grid") {
+							std::uint32_t grid[2];
+							if (read_counts(reader, grid, 2, key)) {
+								p.width = grid[0];
+								p.height = grid[1];
+							}
+						} else if (key == "spacing") {
+							read_positive(reader, p.spacing, key);
+						} else if (key == "pins") {
+							p.pins.clear();
+							reader.begin_array();
+							while (reader.next_element()) {
+								std::uint32_t pin[2];
+								if (read_counts(reader, pin, 2, key)) {
+									p.pins.push_back(glm::uvec2(pin[0], pin[1]));
+								}
+							}
+						} else {
+							known = false;
+						}
+					} break;
+					}
+					if (!known) {
+						reader.fail("unknown " + type + " parameter " + key);
+					}
+				}
+				return reader.ok();
+			}
+
+			//Checks the parameters against each other, once they are all read
+			bool validate(const Scene& scene, std::string& error) {
+				switch (scene.type) {
+				case imgui_panel::ModelType::ChainPendulum:
+					for (std::uint32_t pin : scene.chain_pendulum.pins) {
+						if (pin >= scene.chain_pendulum.mass_count) {
+							error = "pin " + std::to_string(pin) + " is past the end of the chain";
+							return false;
+						}
+					}
+					break;
+				case imgui_panel::ModelType::CubeOfJelly: {
+					const models::CubeOfJellyParameters& p = scene.cube_of_jelly;
+					if (p.width == 0 || p.height == 0 || p.length == 0) {
+						error = "the grid cannot be empty";
+						return false;
+					}
+				} break;
+				case imgui_panel::ModelType::HangingCloth: {
+					const models::HangingClothParameters& p = scene.hanging_cloth;
+					if (p.width < 2 || p.height < 2) {
+						error = "the cloth needs a grid of at least 2 by 2";
+						return false;
+					}
+					for (const glm::uvec2& pin : p.pins) {
+						if (pin.x >= p.width || pin.y >= p.height) {
+							error = "pin [" + std::to_string(pin.x) + ", " + std::to_string(pin.y) + "] is outside the grid";
+							return false;
+						}
+					}
+				} break;
+				default:
+					break;
+				}
+				return true;
+			}
+		}
+
+		bool load(const std::string& path, Scene& scene, std::string& error) {
+			std::FILE* file = std::fopen(path.c_str(), "rb");
+			if (!file) {
+				error = path + ": cannot open";
+				return false;
+			}
+			scene = Scene();
+			json::Reader reader(file);
+			bool has_body = false;
+			std::string key;
+			reader.begin_object();
+			while (reader.next_key(key)) {
+				if (key == "name") {
+					reader.read_string(scene.name);
+				} else if (key == "solver") {
+					read_solver(reader, scene);
+				} else if (key == "body") {
+					has_body = read_body(reader, scene);
+				} else {
+					reader.fail("unknown key " + key);
+				}
+			}
+			reader.end();
+			std::fclose(file);
+
+			if (!reader.ok()) {
+				error = path + ": " + reader.error();
+				return false;
+			}
+			if (!has_body) {
+				error = path + ": no body";
+				return false;
+			}
+			if (!validate(scene, error)) {
+				error = path + ": " + error;
+				return false;
+			}
+			if (scene.name.empty()) {
+				scene.name = std::filesystem::path(path).stem().string();
+			}
+			return true;
+		}
+
+		std::vector<Scene> load_directory(const std::string& directory, std::vector<std::string>& errors) {
+			std::vector<std::string> paths;
+			std::error_code failed;
+			for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(directory, failed)) {
+				if (entry.path().extension() == ".json") {
+					paths.push_back(entry.path().string());
+				}
+			}
+			std::sort(paths.begin(), paths.end());
+
+			std::vector<Scene> scenes;
+			scenes.reserve(paths.size());
+			for (const std::string& path : paths) {
+				Scene scene;
+				std::string error;
+				if (load(path, scene, error)) {
+					scenes.push_back(std::move(scene));
+				} else {
+					errors.push_back(error);
+				}
+			}
+			return scenes;
+		}
+
+		float default_dt(imgui_panel::ModelType type) {
+			switch (type) {
+			case imgui_panel::ModelType::CubeOfJelly:
+			case imgui_panel::ModelType::HangingCloth:
+				return 0.0002f;
+			case imgui_panel::ModelType::ChainPendulum:
+			case imgui_panel::ModelType::MassOnSpring:
+			default:
+				return 0.001f;
+			}
+		}
+
+		std::unique_ptr<models::GenericModel> build(const Scene& scene, models::BuildProgress* progress) {
+			switch (scene.type) {
+			case imgui_panel::ModelType::ChainPendulum:
+				return std::make_unique<models::ChainPendulumModel>(scene.chain_pendulum);
+			case imgui_panel::ModelType::CubeOfJelly:
+				return std::make_unique<models::CubeOfJellyModel>(scene.cube_of_jelly, progress);
+			case imgui_panel::ModelType::HangingCloth:
+				return std::make_unique<models::HangingClothModel>(scene.hanging_cloth, progress);
+			case imgui_panel::ModelType::MassOnSpring:
+			default:
+				return std::make_unique<models::MassOnSpringModel>(scene.mass_on_spring);
+			}
+		}
+
+		bool from_checkpoint(const checkpoint::Snapshot& snapshot, Scene& scene) {
+			const checkpoint::Header& header = snapshot.header();
+			scene.type = imgui_panel::ModelType(header.model_type);
+			switch (scene.type) {
+			case imgui_panel::ModelType::MassOnSpring:
+				return true;
+			case imgui_panel::ModelType::ChainPendulum:
+				//Its spacing comes back with the springs' rest lengths
+				scene.chain_pendulum.mass_count = header.mass_count;
+				return header.mass_count >= 2;
+			case imgui_panel::ModelType::CubeOfJelly:
+				return models::CubeOfJellyModel::saved_parameters(snapshot, scene.cube_of_jelly);
+			case imgui_panel::ModelType::HangingCloth:
+				return models::HangingClothModel::saved_parameters(snapshot, scene.hanging_cloth);
+			default:
+				return false;
+			}
+		}
+
+		bool same_body(const Scene& a, const Scene& b) {
+			if (a.type != b.type) {
+				return false;
+			}
+			switch (a.type) {
+			case imgui_panel::ModelType::ChainPendulum:
+				return a.chain_pendulum.mass_count == b.chain_pendulum.mass_count;
+			case imgui_panel::ModelType::CubeOfJelly:
+				return a.cube_of_jelly.width == b.cube_of_jelly.width && a.cube_of_jelly.height == b.cube_of_jelly.height
+					&& a.cube_of_jelly.length == b.cube_of_jelly.length && a.cube_of_jelly.spacing == b.cube_of_jelly.spacing;
+			case imgui_panel::ModelType::HangingCloth:
+				return a.hanging_cloth.width == b.hanging_cloth.width && a.hanging_cloth.height == b.hanging_cloth.height
+					&& a.hanging_cloth.spacing == b.hanging_cloth.spacing;
+			default:
+				return true;
+			}
+		}
+
+		Builder::~Builder() {
+			if (worker.joinable()) {
+				worker.join();
+			}
+		}
+
+		bool Builder::start(int key, const Scene& scene) {
+			if (building()) {
+				return false;
+			}
+			built_key = key;
+			build_failed = false;
+			build_progress.store(0.f, std::memory_order_relaxed);
+			done.store(false, std::memory_order_relaxed);
+			worker = std::thread([this, scene]() {
+				try {
+					built = build(scene, &build_progress);
+				} catch (const std::bad_alloc&) {
+					built.reset();
+				}
+				done.store(true, std::memory_order_release);
+			});
+			return true;
+		}
+
+		std::unique_ptr<models::GenericModel> Builder::take() {
+			if (!building() || !done.load(std::memory_order_acquire)) {
+				return nullptr;
+			}
+			worker.join();
+			build_failed = !built;
+			if (built) {
+				built->create_renderables();
+			}
+			return std::move(built);
+		}
+	} // namespace scene
+} // namespace simulation
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "imgui_panel.hpp"
+#include "models.hpp"
+
+//Scenes describe a body to simulate and how to step it, in JSON:
+//	{
+//		"name": "Wide Cloth",
+//		"solver": { "dt": 0.0002, "iterations_per_frame": 10 },
+//		"body": { "type": "HangingCloth", "grid": [30, 12], "k": 150, "pins": [[0, 0], [0, 11]] }
+//	}
+//The body's type comes first, then any of its parameters: those in models.hpp, with "grid" or
+//"masses" for its size and "colliders" for the jelly's ground. Files are parsed as they are read,
+//and a scene's model is only built when it is picked.
+namespace simulation {
+	namespace scene {
+		struct Scene {
+			std::string name;
+			imgui_panel::ModelType type = imgui_panel::ModelType::MassOnSpring;
+			//Solver settings, 0 keeps the model's own
+			float dt = 0.f;
+			int iterations_per_frame = 0;
+			//Only the type's parameters are used
+			models::MassOnSpringParameters mass_on_spring;
+			models::ChainPendulumParameters chain_pendulum;
+			models::CubeOfJellyParameters cube_of_jelly;
+			models::HangingClothParameters hanging_cloth;
+		};
+
+		//False (with error saying why and where) if the file cannot be read or is not a scene
+		bool load(const std::string& path, Scene& scene, std::string& error);
+		//Every .json scene in the directory, by file name. Files that fail add to errors.
+		std::vector<Scene> load_directory(const std::string& directory, std::vector<std::string>& errors);
+
+		//The dt a model runs well at
+		float default_dt(imgui_panel::ModelType type);
+		//Sets the scene's body to the type, size and spacing a checkpoint's model was built with,
+		//keeping its other settings. False if the checkpoint does not say.
+		bool from_checkpoint(const checkpoint::Snapshot& snapshot, Scene& scene);
+		//Whether the scenes' bodies have the same type, size and spacing, so a checkpoint of one
+		//restores into the other
+		bool same_body(const Scene& a, const Scene& b);
+
+		//Only the CPU side of the model: call create_renderables() on the GL thread before it is drawn
+		std::unique_ptr<models::GenericModel> build(const Scene& scene, models::BuildProgress* progress = nullptr);
+
+		//Builds one scene at a time on a worker thread. The finished model is taken on the GL thread,
+		//which creates its renderables.
+		class Builder {
+		public:
+			Builder() = default;
+			//Waits for a build still running
+			~Builder();
+
+			Builder(const Builder&) = delete;
+			Builder& operator=(const Builder&) = delete;
+
+			//False if a build is running or not taken yet. The key is handed back with the model.
+			bool start(int key, const Scene& scene);
+			//From start() until the model is taken
+			bool building() const { return worker.joinable(); }
+			int key() const { return built_key; }
+			float progress() const { return build_progress.load(std::memory_order_relaxed); }
+
+			//The finished model with its renderables, null while it is still building (or if it
+			//ran out of memory, which failed() then says)
+			std::unique_ptr<models::GenericModel> take();
+			bool failed() const { return build_failed; }
+
+		private:
+			std::thread worker;
+			std::atomic<bool> done{ false };
+			models::BuildProgress build_progress{ 0.f };
+			std::unique_ptr<models::GenericModel> built;
+			int built_key = 0;
+			bool build_failed = false;
+		};
+	} // namespace scene
+} // namespace simulation
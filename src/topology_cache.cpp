@@ -0,0 +1,102 @@
+#include "topology_cache.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+namespace simulation {
+	namespace topology {
+		namespace {
+			const char magic[8] = { 'M', 'S', 'S', 'T', 'O', 'P', 'O', '1' };
+			constexpr std::uint32_t byte_order_mark = 0x01020304;
+		}
+
+		Key make_key(const char* generator, std::uint32_t generator_version, std::uint32_t width, std::uint32_t height,
+			std::uint32_t length, float spacing, std::size_t mass_count) {
+			Key key;
+			std::memset(&key, 0, sizeof(key));
+			std::strncpy(key.generator, generator, sizeof(key.generator) - 1);
+			key.generator_version = generator_version;
+			key.dimensions[0] = width;
+			key.dimensions[1] = height;
+			key.dimensions[2] = length;
+			key.spacing = spacing;
+			key.mass_count = std::uint32_t(mass_count);
+			return key;
+		}
+
+		//FNV-1a
+		std::uint64_t hash(const Key& key) {
+			const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&key);
+			std::uint64_t h = 0xcbf29ce484222325ull;
+			for (std::size_t n = 0; n < sizeof(key); n++) {
+				h = (h ^ bytes[n]) * 0x100000001b3ull;
+			}
+			return h;
+		}
+
+		std::string path(const Key& key) {
+			char name[64];
+			std::snprintf(name, sizeof(name), "/%s_%016llx.topology", key.generator, (unsigned long long)hash(key));
+			return cache_directory + std::string(name);
+		}
+
+		bool write(const Key& key, const std::vector<Link>& links) {
+			Header header;
+			std::memset(&header, 0, sizeof(header));
+			std::memcpy(header.magic, magic, sizeof(magic));
+			header.version = version;
+			header.byte_order = byte_order_mark;
+			header.link_size = sizeof(Link);
+			header.link_count = std::uint32_t(links.size());
+			header.key = key;
+			header.links_offset = sizeof(Header);
+			header.file_size = header.links_offset + links.size() * sizeof(Link);
+
+			std::error_code failed;
+			std::filesystem::create_directories(cache_directory, failed);
+			std::string target = path(key);
+			std::string temporary = target + ".tmp";
+			std::FILE* file = std::fopen(temporary.c_str(), "wb");
+			if (!file) {
+				return false;
+			}
+			bool written = std::fwrite(&header, sizeof(header), 1, file) == 1;
+			if (written && !links.empty()) {
+				written = std::fwrite(links.data(), sizeof(Link), links.size(), file) == links.size();
+			}
+			written = (std::fclose(file) == 0) && written;
+			if (written) {
+				//rename does not replace an existing file everywhere
+				std::remove(target.c_str());
+				written = std::rename(temporary.c_str(), target.c_str()) == 0;
+			}
+			if (!written) {
+				std::remove(temporary.c_str());
+			}
+			return written;
+		}
+
+		bool Cached::open(const Key& key) {
+			if (!file.open(path(key))) {
+				return false;
+			}
+			const Header* h = reinterpret_cast<const Header*>(file.data());
+			bool valid = file.size() >= sizeof(Header)
+				&& std::memcmp(h->magic, magic, sizeof(magic)) == 0
+				&& h->version == version && h->byte_order == byte_order_mark && h->link_size == sizeof(Link)
+				&& std::memcmp(&h->key, &key, sizeof(Key)) == 0
+				&& h->file_size == file.size()
+				&& h->links_offset >= sizeof(Header)
+				&& file.holds<Link>(h->links_offset, h->link_count);
+			for (std::uint32_t n = 0; valid && n < h->link_count; n++) {
+				const Link& link = links()[n];
+				valid = link.mass_a < key.mass_count && link.mass_b < key.mass_count;
+			}
+			if (!valid) {
+				file.close();
+			}
+			return valid;
+		}
+	} // namespace topology
+} // namespace simulation
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "mapped_file.hpp"
+
+//Spring topologies of the generated models, cached on disk so a large grid is not connected again
+//at every launch. A topology is the pairs of masses joined by springs, with their rest lengths, in
+//the order the model generated them. Each file is named by a hash of what the generator was given,
+//so changed parameters miss the cache rather than load a stale topology. Hits are read back
+//through a memory mapping.
+namespace simulation {
+	namespace topology {
+		constexpr std::uint32_t version = 1;
+		//Relative to the working directory, created on the first write
+		constexpr const char* cache_directory = "cache";
+
+		struct Link {
+			std::uint32_t mass_a;
+			std::uint32_t mass_b;
+			float r;
+		};
+
+		//What a topology was generated from. Only what changes the pairs or their rest lengths is
+		//in it, so a scene with other masses or stiffness reuses the same topology.
+		struct Key {
+			char generator[16];
+			//Bumped by the model when it changes which masses it joins
+			std::uint32_t generator_version;
+			std::uint32_t dimensions[3];
+			float spacing;
+			std::uint32_t mass_count;
+		};
+
+		//Zeroes the padding and unused dimensions, which are hashed and compared byte for byte
+		Key make_key(const char* generator, std::uint32_t generator_version, std::uint32_t width, std::uint32_t height,
+			std::uint32_t length, float spacing, std::size_t mass_count);
+		std::uint64_t hash(const Key& key);
+		//The file the key's topology is cached in
+		std::string path(const Key& key);
+
+		struct Header {
+			char magic[8];
+			std::uint32_t version;
+			//Rejects files from a machine with the other byte order
+			std::uint32_t byte_order;
+			std::uint32_t link_size;
+			std::uint32_t link_count;
+			Key key;
+			std::uint64_t links_offset;
+			std::uint64_t file_size;
+		};
+
+		//Through a temporary file like a checkpoint, so a reader never maps half a topology.
+		//False if the cache directory cannot be written, which only costs the next launch the
+		//generation again.
+		bool write(const Key& key, const std::vector<Link>& links);
+
+		//A mapped topology, with the links straight from the file
+		class Cached {
+		public:
+			//False on a miss: no file, another version, a hash collision with another key, or links
+			//that are out of range
+			bool open(const Key& key);
+
+			const Link* links() const { return reinterpret_cast<const Link*>(file.data() + header().links_offset); }
+			std::uint32_t link_count() const { return header().link_count; }
+
+		private:
+			const Header& header() const { return *reinterpret_cast<const Header*>(file.data()); }
+
+			MappedFile file;
+		};
+	} // namespace topology
+} // namespace simulation
@@ -0,0 +1,129 @@
+#include "profiler.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace profiler {
+	namespace {
+		//Formats and writes the batches handed over by the main thread. Batches are recycled so
+		//a long recording settles into a fixed set of buffers.
+		class TraceWriter {
+		public:
+			explicit TraceWriter(std::FILE* file) : file(file) {
+				std::fputs("{\"traceEvents\":[\n", file);
+				thread = std::thread([this] { run(); });
+			}
+
+			~TraceWriter() {
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					stopping = true;
+				}
+				wake.notify_one();
+				thread.join();
+				std::fputs("\n],\"displayTimeUnit\":\"ms\"}\n", file);
+				std::fclose(file);
+			}
+
+			void push(const Sample* samples, std::size_t count) {
+				std::vector<Sample> batch;
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					if (!free_batches.empty()) {
+						batch = std::move(free_batches.back());
+						free_batches.pop_back();
+					}
+				}
+				batch.assign(samples, samples + count);
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					pending.push_back(std::move(batch));
+				}
+				wake.notify_one();
+			}
+
+		private:
+			void run() {
+				std::vector<std::vector<Sample>> batches;
+				std::unique_lock<std::mutex> lock(mutex);
+				while (true) {
+					wake.wait(lock, [this] { return stopping || !pending.empty(); });
+					batches.swap(pending);
+					bool done = stopping;
+					lock.unlock();
+
+					for (std::vector<Sample>& batch : batches) {
+						write(batch);
+						batch.clear();
+					}
+
+					lock.lock();
+					for (std::vector<Sample>& batch : batches) {
+						free_batches.push_back(std::move(batch));
+					}
+					batches.clear();
+					if (done && pending.empty()) {
+						return;
+					}
+				}
+			}
+
+			//Complete ("X") events, timestamps in microseconds
+			void write(const std::vector<Sample>& batch) {
+				for (const Sample& sample : batch) {
+					const char* category = sample.phase < Phase::GeometryBuild ? "simulation" : "render";
+					std::fprintf(file, "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+						first_event ? "" : ",\n", phase_name(sample.phase), category,
+						sample.start_ns * 1e-3, (sample.end_ns - sample.start_ns) * 1e-3, unsigned(sample.thread));
+					first_event = false;
+				}
+			}
+
+			std::FILE* file;
+			std::thread thread;
+			std::mutex mutex;
+			std::condition_variable wake;
+			std::vector<std::vector<Sample>> pending;
+			std::vector<std::vector<Sample>> free_batches;
+			bool stopping = false;
+			//Only touched by the writer thread
+			bool first_event = true;
+		};
+
+		//Owned by the main thread, the flag lets collect() check it cheaply
+		std::unique_ptr<TraceWriter> writer;
+		std::atomic<bool> recording{ false };
+	}
+
+	bool start_trace(const std::string& path) {
+		stop_trace();
+		std::FILE* file = std::fopen(path.c_str(), "w");
+		if (!file) {
+			return false;
+		}
+		writer = std::make_unique<TraceWriter>(file);
+		recording = true;
+		return true;
+	}
+
+	void stop_trace() {
+		recording = false;
+		//Waits for the writer to finish the queued batches
+		writer.reset();
+	}
+
+	bool tracing() {
+		return recording.load(std::memory_order_relaxed);
+	}
+
+	void trace_samples(const Sample* samples, std::size_t count) {
+		if (writer) {
+			writer->push(samples, count);
+		}
+	}
+} // namespace profiler
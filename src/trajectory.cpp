@@ -0,0 +1,188 @@
+#include "trajectory.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace simulation {
+	namespace trajectory {
+		const char file_magic[8] = { 'M', 'S', 'S', 'T', 'R', 'A', 'J', '1' };
+		const char footer_magic[8] = { 'M', 'S', 'S', 'I', 'N', 'D', 'E', 'X' };
+
+		void Recorder::IndexQueue::reset(std::size_t capacity) {
+			indices.assign(capacity, 0);
+			head = 0;
+			tail = 0;
+		}
+
+		bool Recorder::IndexQueue::push(std::uint32_t index) {
+			std::size_t h = head.load(std::memory_order_relaxed);
+			if (h - tail.load(std::memory_order_acquire) == indices.size()) {
+				return false;
+			}
+			indices[h % indices.size()] = index;
+			head.store(h + 1, std::memory_order_release);
+			return true;
+		}
+
+		bool Recorder::IndexQueue::pop(std::uint32_t& index) {
+			std::size_t t = tail.load(std::memory_order_relaxed);
+			if (t == head.load(std::memory_order_acquire)) {
+				return false;
+			}
+			index = indices[t % indices.size()];
+			tail.store(t + 1, std::memory_order_release);
+			return true;
+		}
+
+		Recorder::~Recorder() {
+			stop();
+		}
+
+		bool Recorder::start(const std::string& path, std::uint32_t model_type, std::size_t mass_count, float dt, const Settings& settings) {
+			stop();
+			file = std::fopen(path.c_str(), "wb");
+			if (!file) {
+				return false;
+			}
+
+			std::memset(&header, 0, sizeof(header));
+			std::memcpy(header.magic, file_magic, sizeof(file_magic));
+			header.version = version;
+			header.model_type = model_type;
+			header.mass_count = std::uint32_t(mass_count);
+			header.frames_per_chunk = std::max<std::uint32_t>(settings.frames_per_chunk, 1);
+			header.precision = settings.precision > 0.f ? settings.precision : Settings().precision;
+			header.dt = dt;
+
+			//Everything the recording needs is allocated here, before the first frame
+			std::size_t buffer_count = std::max<std::size_t>(settings.buffer_count, 2);
+			frames.resize(buffer_count);
+			filled.reset(buffer_count);
+			free_frames.reset(buffer_count);
+			for (std::size_t n = 0; n < buffer_count; n++) {
+				frames[n].positions.resize(mass_count);
+				free_frames.push(std::uint32_t(n));
+			}
+			previous.assign(3 * mass_count, 0);
+			//Varints of small changes are mostly a byte or two
+			chunk.clear();
+			chunk.reserve(header.frames_per_chunk * (sizeof(double) + 6 * mass_count));
+			chunk_frames = 0;
+			index.clear();
+			offset = 0;
+			stopping = false;
+			written = 0;
+			dropped = 0;
+			write_failed = false;
+
+			write(&header, sizeof(header));
+			writer = std::thread([this] { run(); });
+			return true;
+		}
+
+		void Recorder::stop() {
+			if (!writer.joinable()) {
+				return;
+			}
+			stopping.store(true, std::memory_order_release);
+			writer.join();
+
+			write_chunk();
+			Footer footer;
+			std::memset(&footer, 0, sizeof(footer));
+			footer.index_offset = offset;
+			footer.chunk_count = std::uint32_t(index.size());
+			footer.frame_count = std::uint32_t(written.load());
+			std::memcpy(footer.magic, footer_magic, sizeof(footer_magic));
+			write(index.data(), index.size() * sizeof(ChunkEntry));
+			write(&footer, sizeof(footer));
+			std::fclose(file);
+			file = nullptr;
+		}
+
+		bool Recorder::record(const models::GenericModel& model) {
+			std::uint32_t n;
+			if (!recording() || model.mass_count() != header.mass_count || !free_frames.pop(n)) {
+				dropped.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+			frames[n].time = model.time;
+			model.gather_positions(frames[n].positions.data());
+			//Cannot fail, there are only as many buffers as the queue holds
+			filled.push(n);
+			return true;
+		}
+
+		void Recorder::run() {
+			while (true) {
+				//Read before draining, so the frames queued before stop() are all written
+				bool done = stopping.load(std::memory_order_acquire);
+				std::uint32_t n;
+				bool any = false;
+				while (filled.pop(n)) {
+					encode(frames[n]);
+					free_frames.push(n);
+					any = true;
+				}
+				if (done) {
+					return;
+				}
+				if (!any) {
+					std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				}
+			}
+		}
+
+		void Recorder::encode(const Frame& frame) {
+			if (chunk_frames == 0) {
+				chunk_time = frame.time;
+			}
+			const unsigned char* time = reinterpret_cast<const unsigned char*>(&frame.time);
+			chunk.insert(chunk.end(), time, time + sizeof(double));
+
+			//The first frame of a chunk is stored against zero, so it decodes on its own
+			if (chunk_frames == 0) {
+				std::fill(previous.begin(), previous.end(), 0);
+			}
+			double scale = 1.0 / header.precision;
+			for (std::size_t m = 0; m < frame.positions.size(); m++) {
+				for (int c = 0; c < 3; c++) {
+					std::int64_t quantized = std::llround(frame.positions[m][c] * scale);
+					std::int64_t& last = previous[3 * m + c];
+					put_varint(chunk, zigzag(quantized - last));
+					last = quantized;
+				}
+			}
+
+			written.fetch_add(1, std::memory_order_relaxed);
+			if (++chunk_frames == header.frames_per_chunk) {
+				write_chunk();
+			}
+		}
+
+		void Recorder::write_chunk() {
+			if (chunk_frames == 0) {
+				return;
+			}
+			std::uint32_t first_frame = index.empty() ? 0 : index.back().first_frame + index.back().frame_count;
+			index.push_back({ offset, chunk.size(), first_frame, chunk_frames, chunk_time });
+			write(chunk.data(), chunk.size());
+			chunk.clear();
+			chunk_frames = 0;
+		}
+
+		bool Recorder::write(const void* data, std::size_t size) {
+			if (write_failed.load(std::memory_order_relaxed)) {
+				return false;
+			}
+			if (size > 0 && std::fwrite(data, 1, size, file) != size) {
+				write_failed = true;
+				return false;
+			}
+			offset += size;
+			return true;
+		}
+	} // namespace trajectory
+} // namespace simulation
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "models.hpp"
+
+//Recording of the mass positions of a whole run. A file is a header, then chunks of frames, then
+//an index of the chunks and a footer locating it. Positions are quantized to a fixed precision and
+//stored as zigzag varints: the first frame of a chunk as is, the rest as the change from the frame
+//before. Every chunk can be decoded on its own, so a reader seeks with the index.
+namespace simulation {
+	namespace trajectory {
+		constexpr std::uint32_t version = 1;
+
+		struct FileHeader {
+			char magic[8];
+			std::uint32_t version;
+			//imgui_panel::ModelType of the model
+			std::uint32_t model_type;
+			std::uint32_t mass_count;
+			std::uint32_t frames_per_chunk;
+			//Quantization step of the positions
+			float precision;
+			float dt;
+		};
+
+		//Each frame in a chunk is its time (a raw double) then 3 varints per mass
+		struct ChunkEntry {
+			std::uint64_t offset;
+			std::uint64_t size;
+			std::uint32_t first_frame;
+			std::uint32_t frame_count;
+			double first_time;
+		};
+
+		//The last bytes of the file
+		struct Footer {
+			std::uint64_t index_offset;
+			std::uint32_t chunk_count;
+			std::uint32_t frame_count;
+			char magic[8];
+		};
+
+		extern const char file_magic[8];
+		extern const char footer_magic[8];
+
+		struct Settings {
+			//Largest rounding error of a recorded position is half of this
+			float precision = 1e-4f;
+			std::uint32_t frames_per_chunk = 256;
+			//Frames that can be waiting for the writer before new ones are dropped
+			std::size_t buffer_count = 64;
+		};
+
+		//Copies frames on the simulation thread into a pool of buffers allocated up front, and
+		//hands them to a writer thread through lock-free queues, which encodes and writes them.
+		//Recording a frame never waits on the writer or the disk: with every buffer in flight the
+		//frame is dropped instead.
+		class Recorder {
+		public:
+			Recorder() = default;
+			~Recorder();
+
+			Recorder(const Recorder&) = delete;
+			Recorder& operator=(const Recorder&) = delete;
+
+			//Stops any recording in progress. False if the file cannot be created.
+			bool start(const std::string& path, std::uint32_t model_type, std::size_t mass_count, float dt, const Settings& settings = Settings());
+			//Waits for the queued frames, then writes the index
+			void stop();
+			bool recording() const { return writer.joinable(); }
+
+			//Queues the model's current positions. False if the frame was dropped.
+			bool record(const models::GenericModel& model);
+
+			std::uint64_t frames_written() const { return written.load(std::memory_order_relaxed); }
+			std::uint64_t frames_dropped() const { return dropped.load(std::memory_order_relaxed); }
+			//Set by the writer thread if a write failed, the rest of the recording is lost
+			bool failed() const { return write_failed.load(std::memory_order_relaxed); }
+
+		private:
+			//Buffer indices passed between exactly one producer and one consumer
+			class IndexQueue {
+			public:
+				void reset(std::size_t capacity);
+				bool push(std::uint32_t index);
+				bool pop(std::uint32_t& index);
+
+			private:
+				std::vector<std::uint32_t> indices;
+				alignas(64) std::atomic<std::size_t> head{ 0 };
+				alignas(64) std::atomic<std::size_t> tail{ 0 };
+			};
+
+			struct Frame {
+				double time = 0.0;
+				std::vector<glm::vec3> positions;
+			};
+
+			void run();
+			void encode(const Frame& frame);
+			void write_chunk();
+			bool write(const void* data, std::size_t size);
+
+			std::vector<Frame> frames;
+			//Simulation thread to writer, and the buffers handed back
+			IndexQueue filled;
+			IndexQueue free_frames;
+			std::thread writer;
+			std::atomic<bool> stopping{ false };
+			std::atomic<std::uint64_t> written{ 0 };
+			std::atomic<std::uint64_t> dropped{ 0 };
+			std::atomic<bool> write_failed{ false };
+
+			//Only touched by the writer thread while recording
+			std::FILE* file = nullptr;
+			FileHeader header;
+			std::uint64_t offset = 0;
+			std::vector<std::int64_t> previous;
+			std::vector<unsigned char> chunk;
+			std::uint32_t chunk_frames = 0;
+			double chunk_time = 0.0;
+			std::vector<ChunkEntry> index;
+		};
+
+		//Varint coding shared with the readers
+		inline std::uint64_t zigzag(std::int64_t value) {
+			return (std::uint64_t(value) << 1) ^ std::uint64_t(value >> 63);
+		}
+		inline std::int64_t unzigzag(std::uint64_t value) {
+			return std::int64_t(value >> 1) ^ -std::int64_t(value & 1);
+		}
+		inline void put_varint(std::vector<unsigned char>& bytes, std::uint64_t value) {
+			while (value >= 0x80) {
+				bytes.push_back((unsigned char)(value | 0x80));
+				value >>= 7;
+			}
+			bytes.push_back((unsigned char)value);
+		}
+		//Advances bytes past the varint, never reading at or past end
+		inline bool get_varint(const unsigned char*& bytes, const unsigned char* end, std::uint64_t& value) {
+			value = 0;
+			for (int shift = 0; shift < 64 && bytes < end; shift += 7) {
+				unsigned char byte = *bytes++;
+				value |= std::uint64_t(byte & 0x7f) << shift;
+				if (!(byte & 0x80)) {
+					return true;
+				}
+			}
+			return false;
+		}
+	} // namespace trajectory
+} // namespace simulation